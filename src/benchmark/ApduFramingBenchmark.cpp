@@ -0,0 +1,251 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+/*
+ * Cost of the APDU framing of CardTerminal::transmitApdu for each protocol, excluding the PC/SC
+ * exchange: the PC/SC functions are replaced by the fake ones below, answering immediately. The
+ * figures are thus the plugin overhead added to each APDU round trip.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+/* Keyple Plugin Pcsc */
+#include "CardTerminal.h"
+
+#include "Benchmark.h"
+
+using namespace keyple::plugin::pcsc::benchmark;
+using namespace keyple::plugin::pcsc::cpp;
+
+/* Fake PC/SC layer */
+
+const SCARD_IO_REQUEST g_rgSCardT0Pci = {SCARD_PROTOCOL_T0, sizeof(SCARD_IO_REQUEST)};
+const SCARD_IO_REQUEST g_rgSCardT1Pci = {SCARD_PROTOCOL_T1, sizeof(SCARD_IO_REQUEST)};
+const SCARD_IO_REQUEST g_rgSCardRawPci = {SCARD_PROTOCOL_RAW, sizeof(SCARD_IO_REQUEST)};
+
+/* Protocol of the fake card */
+static DWORD gProtocol = SCARD_PROTOCOL_T1;
+
+/* When true, each command is first answered by 61xx, then by the data on the GET RESPONSE */
+static bool gIsChaining = false;
+
+static const BYTE ATR[] = {0x3B, 0x88, 0x80, 0x01, 0x00, 0x00, 0x00, 0x00, 0x33, 0x81, 0x81, 0x00,
+                           0x3A};
+
+LONG SCardEstablishContext(DWORD dwScope, LPCVOID pvReserved1, LPCVOID pvReserved2,
+                           LPSCARDCONTEXT phContext)
+{
+    (void)dwScope;
+    (void)pvReserved1;
+    (void)pvReserved2;
+    *phContext = 1;
+
+    return SCARD_S_SUCCESS;
+}
+
+LONG SCardReleaseContext(SCARDCONTEXT hContext)
+{
+    (void)hContext;
+
+    return SCARD_S_SUCCESS;
+}
+
+LONG SCardIsValidContext(SCARDCONTEXT hContext)
+{
+    (void)hContext;
+
+    return SCARD_S_SUCCESS;
+}
+
+LONG SCardConnect(SCARDCONTEXT hContext, LPCSTR szReader, DWORD dwShareMode,
+                  DWORD dwPreferredProtocols, LPSCARDHANDLE phCard, LPDWORD pdwActiveProtocol)
+{
+    (void)hContext;
+    (void)szReader;
+    (void)dwShareMode;
+    (void)dwPreferredProtocols;
+    *phCard = 1;
+    *pdwActiveProtocol = gProtocol;
+
+    return SCARD_S_SUCCESS;
+}
+
+LONG SCardDisconnect(SCARDHANDLE hCard, DWORD dwDisposition)
+{
+    (void)hCard;
+    (void)dwDisposition;
+
+    return SCARD_S_SUCCESS;
+}
+
+LONG SCardStatus(SCARDHANDLE hCard, LPSTR mszReaderName, LPDWORD pcchReaderLen,
+                 LPDWORD pdwState, LPDWORD pdwProtocol, LPBYTE pbAtr, LPDWORD pcbAtrLen)
+{
+    (void)hCard;
+    (void)mszReaderName;
+    *pcchReaderLen = 0;
+    *pdwState = SCARD_SPECIFIC;
+    *pdwProtocol = gProtocol;
+    memcpy(pbAtr, ATR, sizeof(ATR));
+    *pcbAtrLen = sizeof(ATR);
+
+    return SCARD_S_SUCCESS;
+}
+
+LONG SCardTransmit(SCARDHANDLE hCard, const SCARD_IO_REQUEST* pioSendPci, LPCBYTE pbSendBuffer,
+                   DWORD cbSendLength, SCARD_IO_REQUEST* pioRecvPci, LPBYTE pbRecvBuffer,
+                   LPDWORD pcbRecvLength)
+{
+    (void)hCard;
+    (void)pioSendPci;
+    (void)cbSendLength;
+    (void)pioRecvPci;
+
+    if (gIsChaining && pbSendBuffer[1] != 0xC0) {
+        pbRecvBuffer[0] = 0x61;
+        pbRecvBuffer[1] = 0x10;
+        *pcbRecvLength = 2;
+    } else {
+        memset(pbRecvBuffer, 0x55, 16);
+        pbRecvBuffer[16] = 0x90;
+        pbRecvBuffer[17] = 0x00;
+        *pcbRecvLength = 18;
+    }
+
+    return SCARD_S_SUCCESS;
+}
+
+LONG SCardReconnect(SCARDHANDLE hCard, DWORD dwShareMode, DWORD dwPreferredProtocols,
+                    DWORD dwInitialization, LPDWORD pdwActiveProtocol)
+{
+    (void)hCard;
+    (void)dwShareMode;
+    (void)dwPreferredProtocols;
+    (void)dwInitialization;
+    *pdwActiveProtocol = gProtocol;
+
+    return SCARD_S_SUCCESS;
+}
+
+LONG SCardBeginTransaction(SCARDHANDLE hCard)
+{
+    (void)hCard;
+
+    return SCARD_S_SUCCESS;
+}
+
+LONG SCardEndTransaction(SCARDHANDLE hCard, DWORD dwDisposition)
+{
+    (void)hCard;
+    (void)dwDisposition;
+
+    return SCARD_S_SUCCESS;
+}
+
+LONG SCardGetAttrib(SCARDHANDLE hCard, DWORD dwAttrId, LPBYTE pbAttr, LPDWORD pcbAttrLen)
+{
+    (void)hCard;
+    (void)dwAttrId;
+    (void)pbAttr;
+    (void)pcbAttrLen;
+
+    return SCARD_E_INSUFFICIENT_BUFFER;
+}
+
+/* Not used by the exchanges measured */
+
+LONG SCardGetStatusChange(SCARDCONTEXT hContext, DWORD dwTimeout,
+                          SCARD_READERSTATE* rgReaderStates, DWORD cReaders)
+{
+    (void)hContext;
+    (void)dwTimeout;
+    (void)rgReaderStates;
+    (void)cReaders;
+
+    return SCARD_E_NO_SERVICE;
+}
+
+LONG SCardControl(SCARDHANDLE hCard, DWORD dwControlCode, LPCVOID pbSendBuffer,
+                  DWORD cbSendLength, LPVOID pbRecvBuffer, DWORD cbRecvLength,
+                  LPDWORD lpBytesReturned)
+{
+    (void)hCard;
+    (void)dwControlCode;
+    (void)pbSendBuffer;
+    (void)cbSendLength;
+    (void)pbRecvBuffer;
+    (void)cbRecvLength;
+    (void)lpBytesReturned;
+
+    return SCARD_E_NO_SERVICE;
+}
+
+LONG SCardListReaders(SCARDCONTEXT hContext, LPCSTR mszGroups, LPSTR mszReaders,
+                      LPDWORD pcchReaders)
+{
+    (void)hContext;
+    (void)mszGroups;
+    (void)mszReaders;
+    (void)pcchReaders;
+
+    return SCARD_E_NO_READERS_AVAILABLE;
+}
+
+const char* pcsc_stringify_error(const LONG pcscError)
+{
+    (void)pcscError;
+
+    return "Fake PC/SC error";
+}
+
+static void measureProtocol(const char* name,
+                            const DWORD protocol,
+                            const bool isChaining,
+                            const CardTerminal::ConnectionProtocol connectionProtocol)
+{
+    gProtocol = protocol;
+    gIsChaining = isChaining;
+
+    CardTerminal terminal("Fake reader");
+    terminal.openAndConnect(connectionProtocol, true);
+
+    /* READ RECORD, case 2 */
+    const uint8_t command[] = {0x00, 0xB2, 0x01, 0x0C, 0x10};
+    std::vector<uint8_t> response;
+    response.reserve(64);
+
+    measure(name, 5000000, [&](const int i) {
+        (void)i;
+        response.clear();
+        terminal.transmitApdu(command, sizeof(command), response);
+        return response.size();
+    });
+}
+
+int main()
+{
+    printf("Mean framing overhead per APDU (PC/SC exchange excluded)\n");
+
+    measureProtocol("T=0", SCARD_PROTOCOL_T0, false, CardTerminal::ConnectionProtocol::ANY);
+    measureProtocol("T=0, 61xx", SCARD_PROTOCOL_T0, true, CardTerminal::ConnectionProtocol::ANY);
+    measureProtocol("T=1", SCARD_PROTOCOL_T1, false, CardTerminal::ConnectionProtocol::ANY);
+    measureProtocol("T=1, 61xx", SCARD_PROTOCOL_T1, true, CardTerminal::ConnectionProtocol::ANY);
+    measureProtocol("Direct",
+                    SCARD_PROTOCOL_UNDEFINED,
+                    false,
+                    CardTerminal::ConnectionProtocol::DIRECT);
+
+    return 0;
+}
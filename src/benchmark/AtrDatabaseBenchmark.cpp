@@ -0,0 +1,123 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+/*
+ * Opening and lookup of AtrDatabase files of growing sizes, against a linear scan of the masked
+ * entries. A third of the generated entries have masked bytes.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+/* Keyple Plugin Pcsc */
+#include "AtrDatabase.h"
+
+#include "Benchmark.h"
+
+using namespace keyple::plugin::pcsc::benchmark;
+using namespace keyple::plugin::pcsc::cpp;
+
+static const char* const DATABASE_PATH = "AtrDatabaseBenchmark.kpatrdb";
+
+static std::vector<AtrDatabase::Entry> generateEntries(const size_t entryCount)
+{
+    std::mt19937 random(3);
+    std::vector<AtrDatabase::Entry> entries;
+
+    for (size_t i = 0; i < entryCount; i++) {
+        AtrDatabase::Entry entry;
+        entry.atr = {0x3B, static_cast<uint8_t>(0x80 + random() % 16)};
+        for (int j = 0; j < 12; j++) {
+            entry.atr.push_back(static_cast<uint8_t>(random()));
+        }
+
+        if (i % 3 == 0) {
+            entry.mask.assign(entry.atr.size(), 0xFF);
+            entry.mask[5] = 0x00;
+            entry.mask[6] = 0xF0;
+        }
+
+        entry.cardType = "Card " + std::to_string(i);
+        entries.push_back(entry);
+    }
+
+    return entries;
+}
+
+/* The longest matching entry, the reference behaviour without the automaton */
+static int scan(const std::vector<AtrDatabase::Entry>& entries, const std::vector<uint8_t>& atr)
+{
+    int found = -1;
+    size_t foundLength = 0;
+
+    for (size_t i = 0; i < entries.size(); i++) {
+        const AtrDatabase::Entry& entry = entries[i];
+        if (entry.atr.size() > atr.size() || (found >= 0 && entry.atr.size() <= foundLength)) {
+            continue;
+        }
+
+        bool isMatching = true;
+        for (size_t j = 0; j < entry.atr.size() && isMatching; j++) {
+            const uint8_t mask = entry.mask.empty() ? 0xFF : entry.mask[j];
+            isMatching = (atr[j] & mask) == (entry.atr[j] & mask);
+        }
+
+        if (isMatching) {
+            found = static_cast<int>(i);
+            foundLength = entry.atr.size();
+        }
+    }
+
+    return found;
+}
+
+int main()
+{
+    for (const size_t entryCount : {50, 500, 5000}) {
+        const std::vector<AtrDatabase::Entry> entries = generateEntries(entryCount);
+        AtrDatabase::write(DATABASE_PATH, entries);
+
+        /* ATRs of the entries followed by historical bytes, and as many unknown ATRs */
+        std::vector<std::vector<uint8_t>> atrs;
+        for (const AtrDatabase::Entry& entry : entries) {
+            std::vector<uint8_t> atr = entry.atr;
+            atr.insert(atr.end(), {0x00, 0x00, 0x00, 0x6A});
+            atrs.push_back(atr);
+            atr[1] = 0x3F;
+            atrs.push_back(atr);
+        }
+
+        printf("%zu entries\n", entryCount);
+
+        measure("AtrDatabase::open", 1000, [&](const int i) {
+            (void)i;
+            return AtrDatabase::open(DATABASE_PATH)->getEntryCount();
+        });
+
+        const std::shared_ptr<AtrDatabase> database = AtrDatabase::open(DATABASE_PATH);
+        measure("AtrDatabase::lookup", 1000000, [&](const int i) {
+            return database->lookup(atrs[i % atrs.size()]);
+        });
+
+        measure("Linear scan", 1000000 / static_cast<int>(entryCount), [&](const int i) {
+            return scan(entries, atrs[i % atrs.size()]);
+        });
+    }
+
+    std::remove(DATABASE_PATH);
+
+    return 0;
+}
@@ -0,0 +1,91 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+/*
+ * Identification of the protocols of an ATR with the default rules: one regular expression per
+ * rule on the hex ATR (the former isCurrentProtocol) against a single AtrProtocolClassifier pass.
+ */
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/* Keyple Core Util */
+#include "HexUtil.h"
+#include "Matcher.h"
+#include "Pattern.h"
+
+/* Keyple Plugin Pcsc */
+#include "AtrProtocolClassifier.h"
+#include "PcscSupportedContactProtocol.h"
+#include "PcscSupportedContactlessProtocol.h"
+
+#include "Benchmark.h"
+
+using namespace keyple::core::util;
+using namespace keyple::core::util::cpp;
+using namespace keyple::plugin::pcsc;
+using namespace keyple::plugin::pcsc::benchmark;
+
+int main()
+{
+    const std::vector<std::string> rules = {
+        PcscSupportedContactlessProtocol::ISO_14443_4.getDefaultRule(),
+        PcscSupportedContactlessProtocol::INNOVATRON_B_PRIME_CARD.getDefaultRule(),
+        PcscSupportedContactlessProtocol::MIFARE_ULTRA_LIGHT.getDefaultRule(),
+        PcscSupportedContactlessProtocol::MIFARE_CLASSIC.getDefaultRule(),
+        PcscSupportedContactlessProtocol::MIFARE_DESFIRE.getDefaultRule(),
+        PcscSupportedContactlessProtocol::MEMORY_ST25.getDefaultRule(),
+        PcscSupportedContactProtocol::ISO_7816_3.getDefaultRule(),
+        PcscSupportedContactProtocol::ISO_7816_3_T0.getDefaultRule(),
+        PcscSupportedContactProtocol::ISO_7816_3_T1.getDefaultRule()};
+
+    /* Calypso (ISO 14443-4), Mifare Classic 1K and Desfire */
+    const std::vector<std::vector<uint8_t>> atrs = {
+        {0x3B, 0x88, 0x80, 0x01, 0x00, 0x00, 0x00, 0x00, 0x33, 0x81, 0x81, 0x00, 0x3A},
+        {0x3B, 0x8F, 0x80, 0x01, 0x80, 0x4F, 0x0C, 0xA0, 0x00, 0x00, 0x03, 0x06, 0x03, 0x00, 0x01,
+         0x00, 0x00, 0x00, 0x00, 0x6A},
+        {0x3B, 0x81, 0x80, 0x01, 0x80, 0x80}};
+
+    std::vector<std::shared_ptr<Pattern>> patterns;
+    for (const std::string& rule : rules) {
+        patterns.push_back(std::shared_ptr<Pattern>(Pattern::compile(rule)));
+    }
+
+    const AtrProtocolClassifier classifier(rules);
+    std::vector<bool> protocols;
+
+    printf("%zu rules, %zu ATRs, mean duration per ATR\n", rules.size(), atrs.size());
+
+    const double patternDuration = measure("Pattern per rule", 20000, [&](const int i) {
+        const std::string atrHex = HexUtil::toHex(atrs[i % atrs.size()]);
+        size_t matchCount = 0;
+        for (const std::shared_ptr<Pattern>& pattern : patterns) {
+            matchCount += pattern->matcher(atrHex)->matches() ? 1 : 0;
+        }
+        return matchCount;
+    });
+
+    const double classifierDuration = measure("AtrProtocolClassifier", 20000, [&](const int i) {
+        classifier.classify(atrs[i % atrs.size()], protocols);
+        size_t matchCount = 0;
+        for (const bool isMatching : protocols) {
+            matchCount += isMatching ? 1 : 0;
+        }
+        return matchCount;
+    });
+
+    printf("speedup %.1fx\n", patternDuration / classifierDuration);
+
+    return 0;
+}
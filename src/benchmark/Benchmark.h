@@ -0,0 +1,57 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+
+namespace keyple {
+namespace plugin {
+namespace pcsc {
+namespace benchmark {
+
+/**
+ * Runs an operation the provided number of times, after a warm-up run of a tenth of them, and
+ * prints the mean duration of one run.
+ *
+ * @param name The name printed with the measure.
+ * @param iterations The number of measured runs.
+ * @param operation The operation, returning a value kept alive so that it is not optimized out.
+ * @return The mean duration of one run in nanoseconds.
+ */
+template <typename Operation>
+double measure(const char* name, const int iterations, Operation operation)
+{
+    volatile size_t sink = 0;
+
+    for (int i = 0; i < iterations / 10; i++) {
+        sink = sink + static_cast<size_t>(operation(i));
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        sink = sink + static_cast<size_t>(operation(i));
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    const double nanoseconds =
+        std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+    printf("%-48s %12.1f ns\n", name, nanoseconds);
+
+    return nanoseconds;
+}
+
+}
+}
+}
+}
@@ -12,13 +12,21 @@
 
 #include "AbstractPcscPluginAdapter.h"
 
+#include <chrono>
+#include <condition_variable>
+#include <set>
+
 /* Keyple Plugin Pcsc */
+#include "AbstractPcscReaderAdapter.h"
+#include "CardFarmAdapter.h"
+#include "SamPoolAdapter.h"
 #include "PcscSupportedContactlessProtocol.h"
 #include "PcscSupportedContactProtocol.h"
 
 /* Keyple Core Util */
 #include "Pattern.h"
 #include "KeypleStd.h"
+#include "Exception.h"
 #include "IllegalArgumentException.h"
 #include "IllegalStateException.h"
 
@@ -30,11 +38,23 @@ using namespace keyple::core::util::cpp;
 using namespace keyple::core::util::cpp::exception;
 
 const int AbstractPcscPluginAdapter::MONITORING_CYCLE_DURATION_MS = 1000;
+const size_t AbstractPcscPluginAdapter::MAX_CARD_EVENT_THREAD_COUNT = 1;
+const size_t AbstractPcscPluginAdapter::MAX_CHANNEL_TEARDOWN_THREAD_COUNT = 4;
+const size_t AbstractPcscPluginAdapter::MAX_READER_JOB_THREAD_COUNT = 64;
+const size_t AbstractPcscPluginAdapter::MAX_CARD_FARM_TEARDOWN_THREAD_COUNT = 1;
 
 AbstractPcscPluginAdapter::AbstractPcscPluginAdapter(const std::string& name)
 : mName(name),
   mContactReaderIdentificationFilter(""), 
-  mContactlessReaderIdentificationFilter("")
+  mContactlessReaderIdentificationFilter(""),
+  mContactReaderIdentificationPattern(Pattern::compile("")),
+  mContactlessReaderIdentificationPattern(Pattern::compile("")),
+  mCardTerminalMonitor(std::make_shared<CardTerminalMonitor>()),
+  mCardEventExecutor(std::make_shared<TaskExecutor>(MAX_CARD_EVENT_THREAD_COUNT)),
+  mChannelTeardownExecutor(std::make_shared<TaskExecutor>(MAX_CHANNEL_TEARDOWN_THREAD_COUNT)),
+  mReaderJobExecutor(std::make_shared<TaskExecutor>(MAX_READER_JOB_THREAD_COUNT)),
+  mCardFarmTeardownExecutor(std::make_shared<TaskExecutor>(MAX_CARD_FARM_TEARDOWN_THREAD_COUNT)),
+  mIsAutonomousCardMonitoring(false)
 {
     mProtocolRulesMap = {
         /* Contactless protocols */
@@ -69,6 +89,14 @@ AbstractPcscPluginAdapter::AbstractPcscPluginAdapter(const std::string& name)
             PcscSupportedContactProtocol::ISO_7816_3_T1.getDefaultRule()
         }
     };
+
+    compileProtocolRules();
+}
+
+AbstractPcscPluginAdapter::~AbstractPcscPluginAdapter()
+{
+    /* The executor would discard the pending deletions */
+    mCardFarmTeardownExecutor->waitUntilIdle();
 }
 
 AbstractPcscPluginAdapter& AbstractPcscPluginAdapter::setContactReaderIdentificationFilter(
@@ -83,6 +111,7 @@ AbstractPcscPluginAdapter& AbstractPcscPluginAdapter::setContactReaderIdentifica
     }
     
     mContactReaderIdentificationFilter = contactReaderIdentificationFilter;
+    mContactReaderIdentificationPattern = Pattern::compile(contactReaderIdentificationFilter);
 
     return *this;
 }
@@ -100,6 +129,8 @@ AbstractPcscPluginAdapter& AbstractPcscPluginAdapter::setContactlessReaderIdenti
     }
     
     mContactlessReaderIdentificationFilter = contactlessReaderIdentificationFilter;
+    mContactlessReaderIdentificationPattern =
+        Pattern::compile(contactlessReaderIdentificationFilter);
     
     return *this;
 }
@@ -116,10 +147,45 @@ AbstractPcscPluginAdapter& AbstractPcscPluginAdapter::addProtocolRulesMap(
     }
 
     mProtocolRulesMap.insert(protocolRulesMap.begin(), protocolRulesMap.end());
-    
+
+    compileProtocolRules();
+
     return *this;
 }
 
+void AbstractPcscPluginAdapter::compileProtocolRules()
+{
+    std::lock_guard<std::mutex> lock(mProtocolRulesMutex);
+
+    /* The flags computed by the readers are indexed by identifier, never renumber a protocol */
+    for (const auto& entry : mProtocolRulesMap) {
+        mProtocolIds.insert({entry.first, static_cast<int>(mProtocolIds.size())});
+    }
+
+    std::vector<std::string> protocolRules(mProtocolIds.size());
+    for (const auto& entry : mProtocolRulesMap) {
+        protocolRules[mProtocolIds.at(entry.first)] = entry.second;
+    }
+
+    mAtrProtocolClassifier = std::make_shared<AtrProtocolClassifier>(protocolRules);
+}
+
+int AbstractPcscPluginAdapter::getProtocolId(const std::string& readerProtocol) const
+{
+    std::lock_guard<std::mutex> lock(mProtocolRulesMutex);
+
+    const auto it = mProtocolIds.find(readerProtocol);
+
+    return it != mProtocolIds.end() ? it->second : -1;
+}
+
+std::shared_ptr<AtrProtocolClassifier> AbstractPcscPluginAdapter::getAtrProtocolClassifier() const
+{
+    std::lock_guard<std::mutex> lock(mProtocolRulesMutex);
+
+    return mAtrProtocolClassifier;
+}
+
 const std::string& AbstractPcscPluginAdapter::getProtocolRule(const std::string& readerProtocol) 
     const
 {
@@ -135,15 +201,45 @@ const std::string& AbstractPcscPluginAdapter::getProtocolRule(const std::string&
     }
 }
 
+AbstractPcscPluginAdapter& AbstractPcscPluginAdapter::setAutonomousCardMonitoring(
+    const bool autonomousCardMonitoring)
+{
+    mLogger->trace("%: autonomous card monitoring set to %\n", getName(), autonomousCardMonitoring);
+
+    mIsAutonomousCardMonitoring = autonomousCardMonitoring;
+
+    return *this;
+}
+
+bool AbstractPcscPluginAdapter::isAutonomousCardMonitoring() const
+{
+    return mIsAutonomousCardMonitoring;
+}
+
+AbstractPcscPluginAdapter& AbstractPcscPluginAdapter::setAtrDatabase(
+    std::shared_ptr<AtrDatabase> atrDatabase)
+{
+    if (atrDatabase != nullptr) {
+        mLogger->trace("%: ATR database of % entries\n", getName(), atrDatabase->getEntryCount());
+    }
+
+    mAtrDatabase = atrDatabase;
+
+    return *this;
+}
+
+std::shared_ptr<AtrDatabase> AbstractPcscPluginAdapter::getAtrDatabase() const
+{
+    return mAtrDatabase;
+}
+
 bool AbstractPcscPluginAdapter::isContactless(const std::string& readerName)
 {
-    std::unique_ptr<Pattern> p = Pattern::compile(mContactReaderIdentificationFilter);
-    if (p->matcher(readerName)->matches()) {
+    if (mContactReaderIdentificationPattern->matcher(readerName)->matches()) {
         return false;
     }
 
-    p = Pattern::compile(mContactlessReaderIdentificationFilter);
-    if (p->matcher(readerName)->matches()) {
+    if (mContactlessReaderIdentificationPattern->matcher(readerName)->matches()) {
         return true;
     }
 
@@ -151,6 +247,21 @@ bool AbstractPcscPluginAdapter::isContactless(const std::string& readerName)
                                 readerName);
 }
 
+std::shared_ptr<CardTerminalMonitor> AbstractPcscPluginAdapter::getCardTerminalMonitor() const
+{
+    return mCardTerminalMonitor;
+}
+
+std::shared_ptr<TaskExecutor> AbstractPcscPluginAdapter::getCardEventExecutor() const
+{
+    return mCardEventExecutor;
+}
+
+std::shared_ptr<TaskExecutor> AbstractPcscPluginAdapter::getChannelTeardownExecutor() const
+{
+    return mChannelTeardownExecutor;
+}
+
 const std::vector<std::shared_ptr<CardTerminal>> AbstractPcscPluginAdapter::getCardTerminalList() 
     const
 {
@@ -219,6 +330,183 @@ std::shared_ptr<ReaderSpi> AbstractPcscPluginAdapter::searchReader(const std::st
     return nullptr;
 }
 
+const std::vector<PcscPlugin::ReaderJobResult> AbstractPcscPluginAdapter::runOnReaders(
+    const std::vector<std::shared_ptr<PcscReader>>& readers,
+    const ReaderJob& job,
+    const bool openPhysicalChannel,
+    const bool synchronizedStart)
+{
+    const std::vector<std::shared_ptr<AbstractPcscReaderAdapter>> readerAdapters =
+        getReaderAdapters(readers);
+
+    if (synchronizedStart && readers.size() > MAX_READER_JOB_THREAD_COUNT) {
+        throw IllegalArgumentException("Too many readers for a synchronized start (maximum " +
+                                       std::to_string(MAX_READER_JOB_THREAD_COUNT) + ")");
+    }
+
+    /* State of the run, shared with the jobs */
+    struct Run {
+        std::mutex mutex;
+        std::condition_variable condition;
+        size_t readyCount;
+        size_t completedCount;
+        std::vector<ReaderJobResult> results;
+    };
+
+    auto run = std::make_shared<Run>();
+    run->readyCount = 0;
+    run->completedCount = 0;
+    run->results.resize(readers.size());
+
+    std::unique_lock<std::mutex> synchronizedRunLock(mSynchronizedRunMutex, std::defer_lock);
+    if (synchronizedStart) {
+        synchronizedRunLock.lock();
+    }
+
+    mLogger->debug("%: running a job on % reader(s)\n", getName(), readers.size());
+
+    const size_t readerCount = readers.size();
+    const auto start = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < readerCount; i++) {
+        const std::shared_ptr<AbstractPcscReaderAdapter> readerAdapter = readerAdapters[i];
+
+        mReaderJobExecutor->execute([=]() {
+            ReaderJobResult result;
+            bool isChannelOpenedByJob = false;
+
+            try {
+                if (openPhysicalChannel && !readerAdapter->isPhysicalChannelOpen()) {
+                    readerAdapter->openPhysicalChannel();
+                    isChannelOpenedByJob = true;
+                }
+            } catch (...) {
+                result.error = std::current_exception();
+            }
+
+            if (synchronizedStart) {
+                /* The jobs whose channel opening failed take part in the barrier too */
+                std::unique_lock<std::mutex> lock(run->mutex);
+                if (++run->readyCount == readerCount) {
+                    run->condition.notify_all();
+                } else {
+                    run->condition.wait(lock, [&]() { return run->readyCount == readerCount; });
+                }
+            }
+
+            if (!result.error) {
+                const auto jobStart = std::chrono::steady_clock::now();
+                try {
+                    job(*readerAdapter, i);
+                } catch (...) {
+                    result.error = std::current_exception();
+                }
+
+                const auto jobEnd = std::chrono::steady_clock::now();
+                result.startTime = std::chrono::duration_cast<std::chrono::microseconds>(
+                                       jobStart - start).count();
+                result.duration = std::chrono::duration_cast<std::chrono::microseconds>(
+                                      jobEnd - jobStart).count();
+            }
+
+            if (isChannelOpenedByJob) {
+                try {
+                    readerAdapter->closePhysicalChannel();
+                } catch (const Exception& e) {
+                    mLogger->error("%: error while closing physical channel: %\n",
+                                   readerAdapter->getName(),
+                                   e);
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(run->mutex);
+            run->results[i] = result;
+            if (++run->completedCount == readerCount) {
+                run->condition.notify_all();
+            }
+        });
+    }
+
+    std::unique_lock<std::mutex> lock(run->mutex);
+    run->condition.wait(lock, [&]() { return run->completedCount == readerCount; });
+
+    return run->results;
+}
+
+std::shared_ptr<PcscCardFarm> AbstractPcscPluginAdapter::createCardFarm(
+    const std::vector<std::shared_ptr<PcscReader>>& readers, const bool waitForCardRemoval)
+{
+    const std::vector<std::shared_ptr<AbstractPcscReaderAdapter>> readerAdapters =
+        getReaderAdapters(readers);
+
+    mLogger->debug("%: creating a card farm of % reader(s)\n", getName(), readers.size());
+
+    /* The farm may be released from one of its workers, see CardFarmAdapter::destroy */
+    const std::weak_ptr<TaskExecutor> teardownExecutor = mCardFarmTeardownExecutor;
+
+    return std::shared_ptr<CardFarmAdapter>(
+        new CardFarmAdapter(readerAdapters, waitForCardRemoval),
+        [teardownExecutor](CardFarmAdapter* farm) {
+            CardFarmAdapter::destroy(farm, teardownExecutor);
+        });
+}
+
+std::shared_ptr<PcscSamPool> AbstractPcscPluginAdapter::createSamPool(
+    const std::vector<std::shared_ptr<PcscReader>>& readers,
+    const PcscSamPool::SelectionPolicy selectionPolicy)
+{
+    const std::vector<std::shared_ptr<AbstractPcscReaderAdapter>> readerAdapters =
+        getReaderAdapters(readers);
+
+    mLogger->debug("%: creating a SAM pool of % reader(s)\n", getName(), readers.size());
+
+    /* Shared, the leases keep the pool alive */
+    return std::make_shared<SamPoolAdapter>(readerAdapters, selectionPolicy);
+}
+
+const std::vector<std::shared_ptr<AbstractPcscReaderAdapter>>
+    AbstractPcscPluginAdapter::getReaderAdapters(
+        const std::vector<std::shared_ptr<PcscReader>>& readers)
+{
+    std::vector<std::shared_ptr<AbstractPcscReaderAdapter>> readerAdapters;
+    std::set<const PcscReader*> distinctReaders;
+
+    for (const auto& reader : readers) {
+        auto readerAdapter = std::dynamic_pointer_cast<AbstractPcscReaderAdapter>(reader);
+        if (!readerAdapter) {
+            throw IllegalArgumentException("Reader not provided by a PC/SC plugin");
+        }
+
+        if (!distinctReaders.insert(reader.get()).second) {
+            throw IllegalArgumentException("Reader " + readerAdapter->getName() +
+                                           " provided twice");
+        }
+
+        readerAdapters.push_back(readerAdapter);
+    }
+
+    return readerAdapters;
+}
+
+const std::vector<PcscPlugin::ReaderJobResult> AbstractPcscPluginAdapter::broadcastApdus(
+    const std::vector<std::shared_ptr<PcscReader>>& readers,
+    const std::vector<PcscReader::BatchApdu>& apdus,
+    std::vector<PcscReader::BatchResponse>& batchResponses,
+    const bool synchronizedStart)
+{
+    /* One response per reader, each one filled by a single job */
+    batchResponses.resize(readers.size());
+    PcscReader::BatchResponse* responses = batchResponses.data();
+
+    return runOnReaders(
+        readers,
+        [&apdus, responses](PcscReader& reader, const size_t index) {
+            reader.transmitApdus(apdus, responses[index]);
+        },
+        true,
+        synchronizedStart);
+}
+
 }
 }
 }
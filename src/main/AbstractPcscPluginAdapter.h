@@ -14,26 +14,35 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <typeinfo>
+#include <unordered_map>
 #include <vector>
 
 /* Keyple Core Util */
 #include "LoggerFactory.h"
+#include "Pattern.h"
 
 /* Keyple Core Plugin */
 #include "ObservablePluginSpi.h"
 
 /* Keyple Plugin Pcsc */
+#include "AtrProtocolClassifier.h"
 #include "PcscPlugin.h"
 
+#include "AtrDatabase.h"
 #include "CardTerminal.h"
+#include "CardTerminalMonitor.h"
+#include "TaskExecutor.h"
 
 
 namespace keyple {
 namespace plugin {
 namespace pcsc {
 
+class AbstractPcscReaderAdapter;
+
 using namespace keyple::core::plugin::spi;
 using namespace keyple::core::util::cpp;
 using namespace keyple::plugin::pcsc::cpp;
@@ -56,9 +65,9 @@ public:
     AbstractPcscPluginAdapter(const std::string& name);
 
     /**
-     * 
+     * Waits for the deletion of the card farms released by one of their workers.
      */
-    virtual ~AbstractPcscPluginAdapter() = default;
+    virtual ~AbstractPcscPluginAdapter();
 
     /**
      * (package-private)<br>
@@ -108,6 +117,72 @@ public:
      */
     virtual const std::string& getProtocolRule(const std::string& readerProtocol) const final;
 
+    /**
+     * (package-private)<br>
+     * Gets the identifier of the provided protocol, without throwing when it is unknown.
+     *
+     * <p>The identifier of a protocol never changes, adding rules only assigns identifiers to the
+     * new protocols.
+     *
+     * @param readerProtocol The reader protocol.
+     * @return -1 if no protocol rule is defined for the provided protocol.
+     * @since 2.2.0
+     */
+    virtual int getProtocolId(const std::string& readerProtocol) const final;
+
+    /**
+     * (package-private)<br>
+     * Gets the classifier of the ATRs built from the current protocol rules.
+     *
+     * <p>The flags it produces are indexed by the identifiers returned by getProtocolId.
+     *
+     * @return A not null reference.
+     * @since 2.2.0
+     */
+    virtual std::shared_ptr<AtrProtocolClassifier> getAtrProtocolClassifier() const final;
+
+    /**
+     * (package-private)<br>
+     * Sets how the readers created from now on report the card insertion and removal to Keyple
+     * core.
+     *
+     * @param autonomousCardMonitoring True to create readers notifying the card events by
+     *     themselves, false to create readers providing blocking waiting methods.
+     * @return The object instance.
+     * @since 2.2.0
+     */
+    virtual AbstractPcscPluginAdapter& setAutonomousCardMonitoring(
+        const bool autonomousCardMonitoring) final;
+
+    /**
+     * (package-private)<br>
+     * Tells if the readers notify the card insertion and removal by themselves.
+     *
+     * @return True if the card monitoring is autonomous.
+     * @since 2.2.0
+     */
+    virtual bool isAutonomousCardMonitoring() const final;
+
+    /**
+     * (package-private)<br>
+     * Sets the database used by the readers to identify the card type from the ATR.
+     *
+     * @param atrDatabase The database, null if the card type is not identified.
+     * @return The object instance.
+     * @since 2.2.0
+     */
+    virtual AbstractPcscPluginAdapter& setAtrDatabase(std::shared_ptr<AtrDatabase> atrDatabase)
+        final;
+
+    /**
+     * (package-private)<br>
+     * Gets the database used by the readers to identify the card type from the ATR.
+     *
+     * @return Null if no database has been set.
+     * @since 2.2.0
+     */
+    virtual std::shared_ptr<AtrDatabase> getAtrDatabase() const final;
+
     /**
      * (package-private)<br>
      * Creates a new instance of {@link ReaderSpi} from a {@link CardTerminal}.
@@ -131,6 +206,40 @@ public:
      */
     virtual const std::vector<std::shared_ptr<CardTerminal>> getCardTerminals() const = 0;
 
+    /**
+     * (package-private)<br>
+     * Gets the monitor shared by all the readers of the plugin to watch the card presence.
+     *
+     * <p>Using a single monitor allows the presence of all the readers to be tracked by one
+     * thread instead of one per reader.
+     *
+     * @return A not null reference.
+     * @since 2.2.0
+     */
+    virtual std::shared_ptr<CardTerminalMonitor> getCardTerminalMonitor() const final;
+
+    /**
+     * (package-private)<br>
+     * Gets the pool of threads shared by the readers to deliver the card events to Keyple core.
+     *
+     * <p>The threads are created on demand, up to one per reader having reserved one (see
+     * TaskExecutor::reserveThread).
+     *
+     * @return A not null reference.
+     * @since 2.2.0
+     */
+    virtual std::shared_ptr<TaskExecutor> getCardEventExecutor() const final;
+
+    /**
+     * (package-private)<br>
+     * Gets the pool of threads shared by the readers to close their physical channels
+     * asynchronously.
+     *
+     * @return A not null reference.
+     * @since 2.2.0
+     */
+    virtual std::shared_ptr<TaskExecutor> getChannelTeardownExecutor() const final;
+
     /**
      * (package-private)<br>
      * Attempts to determine the transmission mode of the reader whose name is provided.<br>
@@ -186,6 +295,46 @@ public:
      */
     virtual std::shared_ptr<ReaderSpi> searchReader(const std::string& readerName) override final;
 
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.0
+     */
+    virtual const std::vector<ReaderJobResult> runOnReaders(
+        const std::vector<std::shared_ptr<PcscReader>>& readers,
+        const ReaderJob& job,
+        const bool openPhysicalChannel,
+        const bool synchronizedStart) override final;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.0
+     */
+    virtual const std::vector<ReaderJobResult> broadcastApdus(
+        const std::vector<std::shared_ptr<PcscReader>>& readers,
+        const std::vector<PcscReader::BatchApdu>& apdus,
+        std::vector<PcscReader::BatchResponse>& batchResponses,
+        const bool synchronizedStart) override final;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.0
+     */
+    virtual std::shared_ptr<PcscCardFarm> createCardFarm(
+        const std::vector<std::shared_ptr<PcscReader>>& readers,
+        const bool waitForCardRemoval) override final;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.0
+     */
+    virtual std::shared_ptr<PcscSamPool> createSamPool(
+        const std::vector<std::shared_ptr<PcscReader>>& readers,
+        const PcscSamPool::SelectionPolicy selectionPolicy) override final;
+
 private:
     /**
      * 
@@ -198,6 +347,27 @@ private:
      */
     static const int MONITORING_CYCLE_DURATION_MS;
 
+    /**
+     * Maximum number of threads delivering the card events of autonomous readers, each reader
+     * reserving one more.
+     */
+    static const size_t MAX_CARD_EVENT_THREAD_COUNT;
+
+    /**
+     * Maximum number of threads closing the physical channels asynchronously.
+     */
+    static const size_t MAX_CHANNEL_TEARDOWN_THREAD_COUNT;
+
+    /**
+     * Maximum number of threads running the reader jobs, thus of readers of a synchronized run.
+     */
+    static const size_t MAX_READER_JOB_THREAD_COUNT;
+
+    /**
+     * Maximum number of threads deleting the card farms released by one of their workers.
+     */
+    static const size_t MAX_CARD_FARM_TEARDOWN_THREAD_COUNT;
+
     /**
      * 
      */
@@ -208,6 +378,22 @@ private:
      */
     const std::string mName;
     
+    /**
+     * Identifiers of the protocols of mProtocolRulesMap, indexes of their rules in
+     * mAtrProtocolClassifier, assigned in the order the protocols are added.
+     */
+    std::unordered_map<std::string, int> mProtocolIds;
+
+    /**
+     * Compiled rules of mProtocolRulesMap.
+     */
+    std::shared_ptr<AtrProtocolClassifier> mAtrProtocolClassifier;
+
+    /**
+     * Guards mProtocolIds and mAtrProtocolClassifier, replaced while the readers may use them.
+     */
+    mutable std::mutex mProtocolRulesMutex;
+
     /**
      * 
      */
@@ -218,6 +404,64 @@ private:
      */
     std::string mContactlessReaderIdentificationFilter;
 
+    /**
+     *
+     */
+    std::unique_ptr<Pattern> mContactReaderIdentificationPattern;
+
+    /**
+     *
+     */
+    std::unique_ptr<Pattern> mContactlessReaderIdentificationPattern;
+
+    /**
+     * (private)<br>
+     * Assigns an identifier to the new protocols and compiles the rules of mProtocolRulesMap into a
+     * new classifier.
+     */
+    void compileProtocolRules();
+
+    /**
+     *
+     */
+    const std::shared_ptr<CardTerminalMonitor> mCardTerminalMonitor;
+
+    /**
+     *
+     */
+    const std::shared_ptr<TaskExecutor> mCardEventExecutor;
+
+    /**
+     *
+     */
+    const std::shared_ptr<TaskExecutor> mChannelTeardownExecutor;
+
+    /**
+     *
+     */
+    const std::shared_ptr<TaskExecutor> mReaderJobExecutor;
+
+    /**
+     * Deletes the card farms released by one of their workers, a worker being unable to join
+     * itself.
+     */
+    const std::shared_ptr<TaskExecutor> mCardFarmTeardownExecutor;
+
+    /**
+     * Held during a synchronized run, whose jobs need all their threads at once.
+     */
+    std::mutex mSynchronizedRunMutex;
+
+    /**
+     *
+     */
+    bool mIsAutonomousCardMonitoring;
+
+    /**
+     *
+     */
+    std::shared_ptr<AtrDatabase> mAtrDatabase;
+
     /**
      * (private) Gets the list of terminals provided by smartcard.io.
      *
@@ -227,6 +471,16 @@ private:
      * @throws PluginIOException If an error occurs while accessing the list.
      */
     const std::vector<std::shared_ptr<CardTerminal>> getCardTerminalList() const;
+
+    /**
+     * (private)<br>
+     * Gets the adapters of the readers provided by the application.
+     *
+     * @throw IllegalArgumentException If a reader is null, is not a PC/SC reader or is provided
+     *     twice.
+     */
+    static const std::vector<std::shared_ptr<AbstractPcscReaderAdapter>> getReaderAdapters(
+        const std::vector<std::shared_ptr<PcscReader>>& readers);
 };
 
 }
@@ -13,6 +13,7 @@
 #include "AbstractPcscReaderAdapter.h"
 
 /* Keyple Core Util */
+#include "Exception.h"
 #include "HexUtil.h"
 #include "IllegalArgumentException.h"
 #include "IllegalStateException.h"
@@ -22,7 +23,6 @@
 /* Keyple Core Plugin */
 #include "CardIOException.h"
 #include "ReaderIOException.h"
-#include "TaskCanceledException.h"
 
 /* Keyple Plugin Pcsc */
 #include "CardException.h"
@@ -36,8 +36,6 @@ using namespace keyple::core::util;
 using namespace keyple::core::util::cpp::exception;
 using namespace keyple::plugin::pcsc::cpp::exception;
 
-const long AbstractPcscReaderAdapter::REMOVAL_LATENCY = 500;
-
 AbstractPcscReaderAdapter::AbstractPcscReaderAdapter(
   std::shared_ptr<CardTerminal> terminal, std::shared_ptr<AbstractPcscPluginAdapter> pluginAdapter)
 : mTerminal(terminal),
@@ -47,9 +45,16 @@ AbstractPcscReaderAdapter::AbstractPcscReaderAdapter(
   mIsInitialized(false),
   mIsPhysicalChannelOpen(false),
   mProtocol(IsoProtocol::ANY.getValue()),
+  mConnectionProtocol(CardTerminal::ConnectionProtocol::ANY),
+  mIsProtocolSupported(true),
   mIsModeExclusive(true),
   mDisconnectionMode(DisconnectionMode::RESET),
-  mLoopWaitCardRemoval(false)
+  mIsConnectionReused(false),
+  mIsChannelClosingAsynchronous(false),
+  mIsChannelTeardownPending(false),
+  mCardPresenceTracker(std::make_shared<CardPresenceTracker>()),
+  mIsCardPresenceMonitored(false),
+  mIsIoWorkerReleased(false)
 {
     /* C++ addon */
     if (!terminal) {
@@ -61,6 +66,32 @@ AbstractPcscReaderAdapter::AbstractPcscReaderAdapter(
 #else
     mIsWindows = false;
 #endif
+
+    mCardPresenceTracker->setInsertionFilter(
+        [this](const std::vector<uint8_t>& atr) { return onCardInserted(atr); });
+}
+
+AbstractPcscReaderAdapter::~AbstractPcscReaderAdapter()
+{
+    /*
+     * The queued transmissions refer to this instance, they are failed if not executed yet.
+     * Destroyed unlocked: the running transmission may still submit one.
+     */
+    std::unique_ptr<IoWorker> ioWorker;
+    {
+        std::lock_guard<std::mutex> lock(mIoWorkerMutex);
+        ioWorker = std::move(mIoWorker);
+        mIsIoWorkerReleased = true;
+    }
+    ioWorker.reset();
+
+    /* The monitor may still notify the tracker until the monitoring is stopped */
+    mCardPresenceTracker->setInsertionFilter(nullptr);
+
+    stopCardPresenceMonitoring();
+
+    /* The teardown task refers to this instance */
+    waitForChannelTeardown();
 }
 
 std::shared_ptr<CardTerminal> AbstractPcscReaderAdapter::getTerminal() const
@@ -75,16 +106,7 @@ const std::string& AbstractPcscReaderAdapter::getName() const
 
 bool AbstractPcscReaderAdapter::isProtocolSupported(const std::string& readerProtocol) const
 {
-    /* C++ specific: getProtocolRule throws when protocol not found instead of returning null */
-    try {
-        const std::string rulmIsPhysicalChannelOpen= mPluginAdapter->getProtocolRule(readerProtocol);
-        return true;
-
-    } catch (const IllegalArgumentException& e) {
-        (void)e;
-    }
-
-    return false;
+    return mPluginAdapter->getProtocolId(readerProtocol) >= 0;
 }
 
 void AbstractPcscReaderAdapter::activateProtocol(const std::string& readerProtocol)
@@ -103,23 +125,11 @@ void AbstractPcscReaderAdapter::deactivateProtocol(const std::string& readerProt
 
 bool AbstractPcscReaderAdapter::isCurrentProtocol(const std::string& readerProtocol) const
 {
-    bool isCurrentProtocol = false;
-
-    /* C++ specific: getProtocolRule throws when protocol not found instead of returning null */
-    try {
-        const std::string protocolRule = mPluginAdapter->getProtocolRule(readerProtocol);
-        if (!protocolRule.empty()) {
-            const std::string atr = HexUtil::toHex(mTerminal->getATR());
-            isCurrentProtocol = Pattern::compile(protocolRule)->matcher(atr)->matches();
-        }
+    const int protocolId = mPluginAdapter->getProtocolId(readerProtocol);
 
-        return isCurrentProtocol;
-
-    } catch (const IllegalArgumentException& e) {
-        (void)e;
-    }
-
-    return false;
+    return protocolId >= 0 &&
+           protocolId < static_cast<int>(mCurrentProtocols.size()) &&
+           mCurrentProtocols[protocolId];
 }
 
 void AbstractPcscReaderAdapter::openPhysicalChannel()
@@ -128,13 +138,31 @@ void AbstractPcscReaderAdapter::openPhysicalChannel()
      * Init of the card physical channel: if not yet established, opening of a new physical channel
      */
     try {
+        /* The teardown executor takes the terminal lock, wait for it first */
+        if (!mIsPhysicalChannelOpen) {
+            waitForChannelTeardown();
+        }
+
+        std::lock_guard<std::mutex> lock(mTerminalMutex);
+
         if (!mIsPhysicalChannelOpen) {
             mLogger->debug("%: opening of a card physical channel for protocol '%'\n",
                            getName(),
                            mProtocol);
-            mTerminal->openAndConnect(mProtocol);
+            if (!mIsProtocolSupported) {
+                throw IllegalArgumentException("Unsupported protocol " + mProtocol);
+            }
+
+            mTerminal->openAndConnect(mConnectionProtocol, mIsModeExclusive, getInsertedCardAtr());
+            mPowerOnData = HexUtil::toHex(mTerminal->getATR());
+            mPluginAdapter->getAtrProtocolClassifier()->classify(mTerminal->getATR(),
+                                                                 mCurrentProtocols);
+
+            const std::shared_ptr<AtrDatabase> atrDatabase = mPluginAdapter->getAtrDatabase();
+            mCardType = atrDatabase != nullptr ?
+                            atrDatabase->getCardType(atrDatabase->lookup(mTerminal->getATR())) :
+                            "";
             if (mIsModeExclusive) {
-                mTerminal->beginExclusive();
                 mLogger->debug("%: opening of a card physical channel in exclusive mode\n",
                                getName());
             } else {
@@ -152,9 +180,39 @@ void AbstractPcscReaderAdapter::openPhysicalChannel()
 
 void AbstractPcscReaderAdapter::closePhysicalChannel()
 {
+    if (mIsPhysicalChannelOpen && mIsChannelClosingAsynchronous) {
+        {
+            std::lock_guard<std::mutex> lock(mChannelTeardownMutex);
+            mIsChannelTeardownPending = true;
+        }
+
+        mIsPhysicalChannelOpen = false;
+
+        const DisconnectionMode disconnectionMode = mDisconnectionMode;
+        const bool isConnectionReused = mIsConnectionReused;
+
+        mPluginAdapter->getChannelTeardownExecutor()->execute(
+            [this, disconnectionMode, isConnectionReused]() {
+                try {
+                    std::lock_guard<std::mutex> lock(mTerminalMutex);
+                    mTerminal->closeAndDisconnect(disconnectionMode, isConnectionReused);
+                } catch (const CardException& e) {
+                    mLogger->error("%: error while closing physical channel: %\n", getName(), e);
+                }
+
+                std::lock_guard<std::mutex> lock(mChannelTeardownMutex);
+                mIsChannelTeardownPending = false;
+                mChannelTeardownCondition.notify_all();
+            });
+
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mTerminalMutex);
+
     try {
         if (mIsPhysicalChannelOpen) {
-            mTerminal->closeAndDisconnect(mDisconnectionMode);
+            mTerminal->closeAndDisconnect(mDisconnectionMode, mIsConnectionReused);
         } else {
             mLogger->debug("%: card object found null when closing the physical channel\n",
                            getName());
@@ -174,6 +232,18 @@ bool AbstractPcscReaderAdapter::isPhysicalChannelOpen() const
 
 bool AbstractPcscReaderAdapter::checkCardPresence()
 {
+    /* Without an open channel, the state notified by the monitor is up to date */
+    bool isCardPresent;
+    if (!mIsPhysicalChannelOpen &&
+        mIsCardPresenceMonitored &&
+        mCardPresenceTracker->getLastCardPresence(isCardPresent)) {
+        return isCardPresent;
+    }
+
+    waitForChannelTeardown();
+
+    std::lock_guard<std::mutex> lock(mTerminalMutex);
+
     try {
         return mTerminal->isCardPresent(false);
     } catch (const CardException& e) {
@@ -184,17 +254,95 @@ bool AbstractPcscReaderAdapter::checkCardPresence()
 
 const std::string AbstractPcscReaderAdapter::getPowerOnData() const
 {
-    return HexUtil::toHex(mTerminal->getATR());
+    return mPowerOnData;
+}
+
+const std::string AbstractPcscReaderAdapter::getCardType() const
+{
+    return mCardType;
+}
+
+PcscReader& AbstractPcscReaderAdapter::setInsertedCardFilter(
+    std::shared_ptr<InsertedCardFilter> insertedCardFilter)
+{
+    mLogger->trace("%: set inserted card filter\n", getName());
+
+    std::lock_guard<std::mutex> lock(mInsertedCardMutex);
+
+    mInsertedCardFilter = insertedCardFilter;
+
+    return *this;
+}
+
+const std::vector<uint8_t> AbstractPcscReaderAdapter::getInsertedCardAtr() const
+{
+    std::lock_guard<std::mutex> lock(mInsertedCardMutex);
+
+    return mInsertedCardAtr;
+}
+
+bool AbstractPcscReaderAdapter::isInsertedCardProtocol(const std::string& readerProtocol) const
+{
+    const int protocolId = mPluginAdapter->getProtocolId(readerProtocol);
+
+    std::lock_guard<std::mutex> lock(mInsertedCardMutex);
+
+    return protocolId >= 0 &&
+           protocolId < static_cast<int>(mInsertedCardProtocols.size()) &&
+           mInsertedCardProtocols[protocolId];
+}
+
+bool AbstractPcscReaderAdapter::onCardInserted(const std::vector<uint8_t>& atr)
+{
+    std::shared_ptr<InsertedCardFilter> insertedCardFilter;
+
+    {
+        std::lock_guard<std::mutex> lock(mInsertedCardMutex);
+
+        mInsertedCardAtr = atr;
+        mPluginAdapter->getAtrProtocolClassifier()->classify(atr, mInsertedCardProtocols);
+
+        insertedCardFilter = mInsertedCardFilter;
+    }
+
+    if (insertedCardFilter == nullptr) {
+        return true;
+    }
+
+    /* The filter may query the inserted card fields */
+    bool isAccepted = true;
+    try {
+        isAccepted = insertedCardFilter->accept(atr);
+    } catch (const Exception& e) {
+        mLogger->error("%: error in the inserted card filter: %\n", getName(), e);
+    }
+
+    if (!isAccepted) {
+        mLogger->debug("%: inserted card ignored, ATR = %\n", getName(), HexUtil::toHex(atr));
+    }
+
+    return isAccepted;
 }
 
 const std::vector<uint8_t> AbstractPcscReaderAdapter::transmitApdu(
     const std::vector<uint8_t>& apduCommandData)
 {
     std::vector<uint8_t> apduResponseData;
+    transmitApdu(apduCommandData.data(), apduCommandData.size(), apduResponseData);
+
+    return apduResponseData;
+}
+
+void AbstractPcscReaderAdapter::transmitApdu(const uint8_t* apduCommandData,
+                                             const size_t apduCommandLength,
+                                             std::vector<uint8_t>& apduResponseData)
+{
+    /* Shared with the I/O thread of the asynchronous transmissions */
+    std::lock_guard<std::mutex> lock(mTerminalMutex);
 
     if (mIsPhysicalChannelOpen) {
         try {
-            apduResponseData = mTerminal->transmitApdu(apduCommandData);
+            mTerminal->transmitApdu(apduCommandData, apduCommandLength, apduResponseData);
         } catch (const CardException& e) {
             if (e.getMessage().find("REMOVED") != std::string::npos) {
                 throw CardIOException(getName() + ":" + e.getMessage(),
@@ -212,8 +360,99 @@ const std::vector<uint8_t> AbstractPcscReaderAdapter::transmitApdu(
         /* Could occur if the card was removed */
         throw CardIOException(getName() + ": null channel.");
     }
+}
 
-    return apduResponseData;
+std::future<std::vector<uint8_t>> AbstractPcscReaderAdapter::transmitApduAsync(
+    const std::vector<uint8_t>& apduCommandData)
+{
+    /* std::function requires a copyable task */
+    auto promise = std::make_shared<std::promise<std::vector<uint8_t>>>();
+    std::future<std::vector<uint8_t>> future = promise->get_future();
+
+    const std::string readerName = getName();
+
+    submitIoTask(
+        [this, apduCommandData, promise]() {
+            std::vector<uint8_t> apduResponseData;
+            try {
+                transmitApdu(apduCommandData.data(), apduCommandData.size(), apduResponseData);
+            } catch (...) {
+                promise->set_exception(std::current_exception());
+                return;
+            }
+
+            promise->set_value(std::move(apduResponseData));
+        },
+        [readerName, promise]() {
+            promise->set_exception(std::make_exception_ptr(
+                ReaderIOException(readerName + ": the reader has been released")));
+        });
+
+    return future;
+}
+
+void AbstractPcscReaderAdapter::transmitApduAsync(const std::vector<uint8_t>& apduCommandData,
+                                                  const TransmitCallback& callback)
+{
+    if (!callback) {
+        throw IllegalArgumentException("callback should not be null");
+    }
+
+    const std::string readerName = getName();
+
+    submitIoTask(
+        [this, apduCommandData, callback]() {
+            std::vector<uint8_t> apduResponseData;
+            std::exception_ptr error;
+            try {
+                transmitApdu(apduCommandData.data(), apduCommandData.size(), apduResponseData);
+            } catch (...) {
+                error = std::current_exception();
+            }
+
+            callback(apduResponseData, error);
+        },
+        [readerName, callback]() {
+            callback(std::vector<uint8_t>(),
+                     std::make_exception_ptr(
+                         ReaderIOException(readerName + ": the reader has been released")));
+        });
+}
+
+const PcscReader::AsyncTransmitMetrics AbstractPcscReaderAdapter::getAsyncTransmitMetrics()
+    const
+{
+    AsyncTransmitMetrics metrics;
+
+    std::lock_guard<std::mutex> lock(mIoWorkerMutex);
+
+    if (mIoWorker) {
+        metrics.queueDepth = mIoWorker->getQueueDepth();
+        metrics.transmittedCount = mIoWorker->getExecutedTaskCount();
+        metrics.totalWaitTime = mIoWorker->getTotalWaitTime();
+        metrics.maxWaitTime = mIoWorker->getMaxWaitTime();
+    }
+
+    return metrics;
+}
+
+void AbstractPcscReaderAdapter::submitIoTask(const std::function<void()>& task,
+                                             const std::function<void()>& discard)
+{
+    std::lock_guard<std::mutex> lock(mIoWorkerMutex);
+
+    if (mIsIoWorkerReleased) {
+        throw IllegalStateException(getName() + ": the I/O thread is stopped");
+    }
+
+    if (!mIoWorker) {
+        mLogger->debug("%: starting the I/O thread\n", getName());
+        mIoWorker.reset(new IoWorker(getName()));
+    }
+
+    if (!mIoWorker->submit(task, discard)) {
+        throw IllegalStateException(getName() + ": the I/O thread is stopped");
+    }
 }
 
 bool AbstractPcscReaderAdapter::isContactless()
@@ -231,17 +470,25 @@ bool AbstractPcscReaderAdapter::isContactless()
 
 void AbstractPcscReaderAdapter::onUnregister()
 {
-    /* Nothing to do here in this reader */
+    stopCardPresenceMonitoring();
+
+    /* Releases the connection kept since the last channel, if any */
+    if (!mIsPhysicalChannelOpen) {
+        waitForChannelTeardown();
+
+        std::lock_guard<std::mutex> lock(mTerminalMutex);
+        mTerminal->closeAndDisconnect(DisconnectionMode::LEAVE, false);
+    }
 }
 
 void AbstractPcscReaderAdapter::onStartDetection()
 {
-    /* Nothing to do here in this reader */
+    startCardPresenceMonitoring();
 }
 
 void AbstractPcscReaderAdapter::onStopDetection()
 {
-    /* Nothing to do here in this reader */
+    stopCardPresenceMonitoring();
 }
 
 PcscReader& AbstractPcscReaderAdapter::setSharingMode(const SharingMode sharingMode)
@@ -250,6 +497,8 @@ PcscReader& AbstractPcscReaderAdapter::setSharingMode(const SharingMode sharingM
 
     if (sharingMode == SharingMode::SHARED) {
         /* If a card is present, change the mode immediately */
+        std::lock_guard<std::mutex> lock(mTerminalMutex);
+
         if (mIsPhysicalChannelOpen) {
             try {
                 mTerminal->endExclusive();
@@ -261,6 +510,18 @@ PcscReader& AbstractPcscReaderAdapter::setSharingMode(const SharingMode sharingM
 
         mIsModeExclusive = false;
     } else if (sharingMode == SharingMode::EXCLUSIVE) {
+        /* If a card is present, change the mode immediately */
+        std::lock_guard<std::mutex> lock(mTerminalMutex);
+
+        if (mIsPhysicalChannelOpen) {
+            try {
+                mTerminal->beginExclusive();
+            } catch (const CardException& e) {
+                throw IllegalStateException("Couldn't enable exclusive mode",
+                                            std::make_shared<CardException>(e));
+            }
+        }
+
         mIsModeExclusive = true;
     }
 
@@ -283,6 +544,9 @@ PcscReader& AbstractPcscReaderAdapter::setIsoProtocol(const IsoProtocol& isoProt
 
     mProtocol = isoProtocol.getValue();
 
+    /* Resolved once, the connections then use the enumerated value */
+    mIsProtocolSupported = CardTerminal::getConnectionProtocol(mProtocol, mConnectionProtocol);
+
     return *this;
 }
 
@@ -296,45 +560,33 @@ PcscReader& AbstractPcscReaderAdapter::setDisconnectionMode(
     return *this;
 }
 
-void AbstractPcscReaderAdapter::waitForCardRemoval()
+PcscReader& AbstractPcscReaderAdapter::setConnectionReuse(const bool connectionReuse)
 {
-    mLogger->trace("%: start waiting for the removal of the card in a loop with a latency of % " \
-                   "ms\n",
-                   getName(),
-                   REMOVAL_LATENCY);
-
+    mLogger->trace("%: set connection reuse to %\n", getName(), connectionReuse);
 
-    /* Activate loop */
-    mLoopWaitCardRemoval = true;
+    mIsConnectionReused = connectionReuse;
 
-    try {
-        while (mLoopWaitCardRemoval) {
-            if (getTerminal()->waitForCardAbsent(REMOVAL_LATENCY)) {
-                /* Card removed */
-                mLogger->trace("%: card removed\n", getName());
-                return;
-            }
+    /* Releases the connection kept since the last channel, if any */
+    if (!connectionReuse && !mIsPhysicalChannelOpen) {
+        waitForChannelTeardown();
 
-            // if (Thread.interrupted()) {
-            //     break;
-            // }
-        }
-    } catch (const CardException& e) {
-        /* Here, it is a communication failure with the reader */
-        throw ReaderIOException(getName() +
-                                ": an error occurred while waiting for the card removal.",
-                                std::make_shared<CardException>(e));
+        std::lock_guard<std::mutex> lock(mTerminalMutex);
+        mTerminal->closeAndDisconnect(DisconnectionMode::LEAVE, false);
     }
 
-    throw TaskCanceledException(getName() +
-                                ": the wait for the card removal task has been cancelled.");
+    return *this;
 }
 
-void AbstractPcscReaderAdapter::stopWaitForCardRemoval()
+PcscReader& AbstractPcscReaderAdapter::setAsynchronousChannelClosing(
+    const bool asynchronousChannelClosing)
 {
-    mLogger->trace("%: stop waiting for the card removal requested\n", getName());
+    mLogger->trace("%: set asynchronous channel closing to %\n",
+                   getName(),
+                   asynchronousChannelClosing);
+
+    mIsChannelClosingAsynchronous = asynchronousChannelClosing;
 
-    mLoopWaitCardRemoval = false;
+    return *this;
 }
 
 /*
@@ -361,6 +613,10 @@ const std::vector<uint8_t> AbstractPcscReaderAdapter::transmitControlCommand(
     std::vector<uint8_t> response;
     const int controlCode = mIsWindows ? 0x00310000 | (commandId << 2) : 0x42000000 | commandId;
 
+    waitForChannelTeardown();
+
+    std::lock_guard<std::mutex> lock(mTerminalMutex);
+
     try {
         if (mTerminal != nullptr) {
             response = mTerminal->transmitControlCommand(controlCode, command);
@@ -387,6 +643,91 @@ int AbstractPcscReaderAdapter::getIoctlCcidEscapeCommandId() const
     return mIsWindows ? 3500 : 1;
 }
 
+void AbstractPcscReaderAdapter::transmitApdus(const std::vector<BatchApdu>& apdus,
+                                              BatchResponse& batchResponse)
+{
+    std::lock_guard<std::mutex> lock(mTerminalMutex);
+
+    if (!mIsPhysicalChannelOpen) {
+        /* Could occur if the card was removed */
+        throw CardIOException(getName() + ": null channel.");
+    }
+
+    try {
+        mTerminal->transmitApdus(apdus, batchResponse);
+    } catch (const CardException& e) {
+        if (e.getMessage().find("REMOVED") != std::string::npos) {
+            throw CardIOException(getName() + ":" + e.getMessage(),
+                                  std::make_shared<CardException>(e));
+        } else {
+            throw ReaderIOException(getName() + ":" + e.getMessage(),
+                                    std::make_shared<CardException>(e));
+        }
+    } catch (const IllegalStateException& e) {
+        /* Card could have been removed prematurely */
+        throw CardIOException(getName() + ":" + e.getMessage(),
+                              std::make_shared<IllegalStateException>(e));
+    }
+}
+
+CardPresenceTracker::WaitResult AbstractPcscReaderAdapter::waitForCardPresence(
+    const bool present, const long timeout)
+{
+    startCardPresenceMonitoring();
+
+    return mCardPresenceTracker->waitForCardPresence(present, timeout);
+}
+
+void AbstractPcscReaderAdapter::cancelWaitForCardPresence(const bool present)
+{
+    mCardPresenceTracker->cancel(present);
+}
+
+void AbstractPcscReaderAdapter::setCardPresenceListener(
+    std::shared_ptr<CardPresenceListener> listener)
+{
+    mCardPresenceTracker->setNextListener(listener);
+}
+
+std::shared_ptr<AbstractPcscPluginAdapter> AbstractPcscReaderAdapter::getPluginAdapter() const
+{
+    return mPluginAdapter;
+}
+
+void AbstractPcscReaderAdapter::waitForChannelTeardown()
+{
+    std::unique_lock<std::mutex> lock(mChannelTeardownMutex);
+
+    if (mIsChannelTeardownPending) {
+        mLogger->trace("%: waiting for the end of the channel teardown\n", getName());
+        mChannelTeardownCondition.wait(lock, [this]() { return !mIsChannelTeardownPending; });
+    }
+}
+
+void AbstractPcscReaderAdapter::startCardPresenceMonitoring()
+{
+    if (mIsCardPresenceMonitored.exchange(true)) {
+        return;
+    }
+
+    mLogger->trace("%: start monitoring the card presence\n", getName());
+
+    mCardPresenceTracker->reset();
+    mPluginAdapter->getCardTerminalMonitor()->addTerminal(getName(), mCardPresenceTracker);
+}
+
+void AbstractPcscReaderAdapter::stopCardPresenceMonitoring()
+{
+    if (!mIsCardPresenceMonitored.exchange(false)) {
+        return;
+    }
+
+    mLogger->trace("%: stop monitoring the card presence\n", getName());
+
+    mPluginAdapter->getCardTerminalMonitor()->removeTerminal(getName());
+    mCardPresenceTracker->reset();
+}
+
 }
 }
 }
@@ -13,18 +13,21 @@
 #pragma once
 
 #include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <typeinfo>
 
 /* Keyple Plugin Pcsc */
 #include "AbstractPcscPluginAdapter.h"
+#include "CardPresenceTracker.h"
 #include "CardTerminal.h"
 #include "ConfigurableReaderSpi.h"
+#include "IoWorker.h"
 #include "PcscReader.h"
 
 /* Keyple Core Plugin */
 #include "DontWaitForCardRemovalDuringProcessingSpi.h"
 #include "ObservableReaderSpi.h"
-#include "WaitForCardRemovalBlockingSpi.h"
 
 /* Keyple Core Util */
 #include "LoggerFactory.h"
@@ -35,7 +38,6 @@ namespace pcsc {
 
 using namespace keyple::core::plugin::spi::reader::observable;
 using namespace keyple::core::plugin::spi::reader::observable::state::processing;
-using namespace keyple::core::plugin::spi::reader::observable::state::removal;
 using namespace keyple::core::util::cpp;
 using namespace keyple::plugin::pcsc::cpp;
 
@@ -49,9 +51,13 @@ class AbstractPcscReaderAdapter
 : public PcscReader,
   public ConfigurableReaderSpi,
   public ObservableReaderSpi,
-  public DontWaitForCardRemovalDuringProcessingSpi,
-  public WaitForCardRemovalBlockingSpi {
+  public DontWaitForCardRemovalDuringProcessingSpi {
 public:
+    /**
+     * Waits for the cards of the farm readers.
+     */
+    friend class CardFarmAdapter;
+
     /**
      * (package-private)<br>
      * Creates an instance the class, keeps the terminal and parent plugin, extract the reader name
@@ -65,9 +71,9 @@ public:
                               std::shared_ptr<AbstractPcscPluginAdapter> pluginAdapter);
 
     /**
-     *
+     * Stops the card presence monitoring of the reader if active.
      */
-    virtual ~AbstractPcscReaderAdapter() = default;
+    virtual ~AbstractPcscReaderAdapter();
 
     /**
      * (package-private)<br>
@@ -161,6 +167,24 @@ public:
      */
     const std::vector<uint8_t> transmitApdu(const std::vector<uint8_t>& apduCommandData) final;
 
+    /**
+     * Transmits an APDU, receiving the response directly into the provided buffer.
+     *
+     * <p>Unlike transmitApdu(const std::vector<uint8_t>&), no intermediate buffer is involved: when
+     * the same response buffer is reused for all the APDUs of a transaction, the exchanges perform
+     * no heap allocation once the buffer has grown to the size of the largest response.
+     *
+     * @param apduCommandData The command.
+     * @param apduCommandLength The length of the command.
+     * @param apduResponseData The buffer receiving the response (data and status word).
+     * @throw ReaderIOException If the communication with the reader has failed.
+     * @throw CardIOException If the communication with the card has failed.
+     * @since 2.2.0
+     */
+    virtual void transmitApdu(const uint8_t* apduCommandData,
+                              const size_t apduCommandLength,
+                              std::vector<uint8_t>& apduResponseData) final;
+
     /**
      * {@inheritDoc}
      *
@@ -226,16 +250,68 @@ public:
     /**
      * {@inheritDoc}
      *
-     * @since 2.0.0
+     * @since 2.2.0
      */
-    void waitForCardRemoval() final;
+    PcscReader& setConnectionReuse(const bool connectionReuse) final;
 
     /**
      * {@inheritDoc}
      *
-     * @since 2.0.0
+     * @since 2.2.0
+     */
+    PcscReader& setAsynchronousChannelClosing(const bool asynchronousChannelClosing) final;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.0
+     */
+    const std::string getCardType() const final;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.0
+     */
+    PcscReader& setInsertedCardFilter(std::shared_ptr<InsertedCardFilter> insertedCardFilter)
+        final;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.0
      */
-    void stopWaitForCardRemoval() final;
+    const std::vector<uint8_t> getInsertedCardAtr() const final;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.0
+     */
+    bool isInsertedCardProtocol(const std::string& readerProtocol) const final;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.0
+     */
+    std::future<std::vector<uint8_t>> transmitApduAsync(
+        const std::vector<uint8_t>& apduCommandData) final;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.0
+     */
+    void transmitApduAsync(const std::vector<uint8_t>& apduCommandData,
+                           const TransmitCallback& callback) final;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.0
+     */
+    const AsyncTransmitMetrics getAsyncTransmitMetrics() const final;
 
     /**
      * {@inheritDoc}
@@ -272,6 +348,56 @@ public:
      */
     int getIoctlCcidEscapeCommandId() const override;
 
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.0
+     */
+    void transmitApdus(const std::vector<BatchApdu>& apdus, BatchResponse& batchResponse) override;
+
+protected:
+    /**
+     * (package-private)<br>
+     * Waits until the card presence notified by the plugin monitor matches the expected one.
+     *
+     * <p>The reader is registered to the monitor of the plugin if not done yet.
+     *
+     * @param present The expected card presence.
+     * @param timeout The maximum time to wait (in milliseconds).
+     * @return The outcome of the wait.
+     * @throw CardException If the card presence monitoring has failed and not recovered yet.
+     * @since 2.2.0
+     */
+    CardPresenceTracker::WaitResult waitForCardPresence(const bool present, const long timeout);
+
+    /**
+     * (package-private)<br>
+     * Immediately releases the threads blocked in waitForCardPresence for the provided presence,
+     * or the next one if the wait has not started yet.
+     *
+     * @param present The card presence awaited by the waits to cancel.
+     * @since 2.2.0
+     */
+    void cancelWaitForCardPresence(const bool present);
+
+    /**
+     * (package-private)<br>
+     * Sets a listener notified of the card presence changes once the reader is monitored.
+     *
+     * @param listener The listener, null to remove it.
+     * @since 2.2.0
+     */
+    void setCardPresenceListener(std::shared_ptr<CardPresenceListener> listener);
+
+    /**
+     * (package-private)<br>
+     * Gets the parent plugin.
+     *
+     * @return A not null reference.
+     * @since 2.2.0
+     */
+    std::shared_ptr<AbstractPcscPluginAdapter> getPluginAdapter() const;
+
 private:
     /**
      *
@@ -310,15 +436,67 @@ private:
     bool mIsInitialized;
 
     /**
-     *
+     * Also read by the I/O thread and the teardown executor.
      */
-    bool mIsPhysicalChannelOpen;
+    std::atomic<bool> mIsPhysicalChannelOpen;
+
+    /**
+     * Serializes the operations on mTerminal, made from the caller threads, the I/O thread of the
+     * asynchronous transmissions and the channel teardown executor.
+     */
+    std::mutex mTerminalMutex;
 
     /**
      *
      */
     std::string mProtocol;
 
+    /**
+     * Connection protocol designated by mProtocol.
+     */
+    CardTerminal::ConnectionProtocol mConnectionProtocol;
+
+    /**
+     * False if mProtocol does not designate a connection protocol.
+     */
+    bool mIsProtocolSupported;
+
+    /**
+     * ATR of the card connected by the last channel opening, as an hex string.
+     */
+    std::string mPowerOnData;
+
+    /**
+     * Protocols matched by the ATR of the card connected by the last channel opening, indexed by
+     * protocol identifier.
+     */
+    std::vector<bool> mCurrentProtocols;
+
+    /**
+     * Card type of the card connected by the last channel opening, empty if unknown.
+     */
+    std::string mCardType;
+
+    /**
+     * Guards the inserted card fields, updated by the monitoring thread.
+     */
+    mutable std::mutex mInsertedCardMutex;
+
+    /**
+     *
+     */
+    std::shared_ptr<InsertedCardFilter> mInsertedCardFilter;
+
+    /**
+     * ATR of the last inserted card, reported with the card presence.
+     */
+    std::vector<uint8_t> mInsertedCardAtr;
+
+    /**
+     * Protocols matched by mInsertedCardAtr, indexed by protocol identifier.
+     */
+    std::vector<bool> mInsertedCardProtocols;
+
     /**
      *
      */
@@ -330,18 +508,89 @@ private:
     DisconnectionMode mDisconnectionMode;
 
     /**
-     * The latency delay value (in ms) determines the maximum time during which the
-     * waitForCardAbsent blocking functions will execute.
-     * This will correspond to the capacity to react to the interrupt signal of
-     * the thread (see cancel method of the Future object)
+     *
+     */
+    bool mIsConnectionReused;
+
+    /**
+     *
+     */
+    bool mIsChannelClosingAsynchronous;
+
+    /**
+     *
      */
-    static const long REMOVAL_LATENCY;
+    std::mutex mChannelTeardownMutex;
 
     /**
      *
      */
-    std::atomic<bool> mLoopWaitCardRemoval;
+    std::condition_variable mChannelTeardownCondition;
+
+    /**
+     * True while the channel closed asynchronously is being released.
+     */
+    bool mIsChannelTeardownPending;
 
+    /**
+     * Card presence notified by the monitor of the plugin.
+     */
+    const std::shared_ptr<CardPresenceTracker> mCardPresenceTracker;
+
+    /**
+     *
+     */
+    std::atomic<bool> mIsCardPresenceMonitored;
+
+    /**
+     * Guards mIoWorker and mIsIoWorkerReleased.
+     */
+    mutable std::mutex mIoWorkerMutex;
+
+    /**
+     * I/O thread of the asynchronous transmissions, started by the first one.
+     */
+    std::unique_ptr<IoWorker> mIoWorker;
+
+    /**
+     * True once the I/O thread is released by the destructor, no task can be submitted anymore.
+     */
+    bool mIsIoWorkerReleased;
+
+    /**
+     * (private)<br>
+     * Queues a task to the I/O thread, starting it if needed.
+     *
+     * @param task The task.
+     * @param discard Called instead of the task if the reader is destroyed before executing it.
+     */
+    void submitIoTask(const std::function<void()>& task, const std::function<void()>& discard);
+
+    /**
+     * (private)<br>
+     * Blocks until the teardown of the channel closed asynchronously, if any, has completed.
+     */
+    void waitForChannelTeardown();
+
+    /**
+     * (private)<br>
+     * Classifies the ATR of an inserted card and submits it to the inserted card filter.
+     *
+     * @return false if the card must be ignored.
+     */
+    bool onCardInserted(const std::vector<uint8_t>& atr);
+
+    /**
+     * (private)<br>
+     * Registers the reader to the monitor of the plugin if not done yet.
+     */
+    void startCardPresenceMonitoring();
+
+    /**
+     * (private)<br>
+     * Unregisters the reader from the monitor of the plugin if registered.
+     */
+    void stopCardPresenceMonitoring();
 };
 
 }
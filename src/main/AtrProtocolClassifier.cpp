@@ -0,0 +1,166 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include "AtrProtocolClassifier.h"
+
+/* Keyple Core Util */
+#include "HexUtil.h"
+#include "Matcher.h"
+
+namespace keyple {
+namespace plugin {
+namespace pcsc {
+
+using namespace keyple::core::util;
+
+const uint8_t AtrProtocolClassifier::NO_NIBBLE = 0xFF;
+
+AtrProtocolClassifier::AtrProtocolClassifier(const std::vector<std::string>& protocolRules)
+: mProtocolCount(protocolRules.size())
+{
+    for (size_t i = 0; i < protocolRules.size(); i++) {
+        const int protocolId = static_cast<int>(i);
+        const std::string& protocolRule = protocolRules[i];
+
+        if (protocolRule.empty()) {
+            continue;
+        }
+
+        const size_t elementCount = mElements.size();
+        const size_t startPositionCount = mStartPositions.size();
+
+        if (!compile(protocolId, protocolRule)) {
+            /* Unsupported construct, the rule is evaluated on its own */
+            mElements.resize(elementCount);
+            mStartPositions.resize(startPositionCount);
+            mFallbackPatterns.push_back(
+                {protocolId, std::shared_ptr<Pattern>(Pattern::compile(protocolRule))});
+        }
+    }
+}
+
+bool AtrProtocolClassifier::compile(const int protocolId, const std::string& protocolRule)
+{
+    mStartPositions.push_back(mElements.size());
+
+    for (size_t i = 0; i < protocolRule.size(); i++) {
+        const char c = protocolRule[i];
+
+        if (c >= '0' && c <= '9') {
+            mElements.push_back({ElementType::NIBBLE, static_cast<uint8_t>(c - '0'), -1});
+        } else if (c >= 'A' && c <= 'F') {
+            mElements.push_back({ElementType::NIBBLE, static_cast<uint8_t>(c - 'A' + 10), -1});
+        } else if ((c >= 'G' && c <= 'Z') || (c >= 'a' && c <= 'z')) {
+            /* Never found in the uppercase hex string of an ATR (e.g. "X" disabling a protocol) */
+            mElements.push_back({ElementType::NIBBLE, NO_NIBBLE, -1});
+        } else if (c == '.' && i + 1 < protocolRule.size() && protocolRule[i + 1] == '*') {
+            mElements.push_back({ElementType::ANY_SEQUENCE, 0, -1});
+            i++;
+        } else if (c == '.') {
+            mElements.push_back({ElementType::ANY, 0, -1});
+        } else if (c == '|') {
+            /* No group is supported, the alternatives are at the top level */
+            mElements.push_back({ElementType::ACCEPT, 0, protocolId});
+            mStartPositions.push_back(mElements.size());
+        } else {
+            return false;
+        }
+    }
+
+    mElements.push_back({ElementType::ACCEPT, 0, protocolId});
+
+    return true;
+}
+
+void AtrProtocolClassifier::activate(size_t position,
+                                     const size_t step,
+                                     std::vector<size_t>& positions,
+                                     std::vector<size_t>& steps) const
+{
+    while (steps[position] != step) {
+        steps[position] = step;
+        positions.push_back(position);
+
+        /* ".*" may match an empty sequence */
+        if (mElements[position].type != ElementType::ANY_SEQUENCE) {
+            break;
+        }
+
+        position++;
+    }
+}
+
+void AtrProtocolClassifier::classify(const std::vector<uint8_t>& atr,
+                                     std::vector<bool>& protocols) const
+{
+    protocols.assign(mProtocolCount, false);
+
+    if (!mElements.empty()) {
+        /* Active positions, and for each position the last step it has been activated at */
+        std::vector<size_t> current;
+        std::vector<size_t> next;
+        std::vector<size_t> steps(mElements.size(), 0);
+        size_t step = 1;
+
+        current.reserve(mElements.size());
+        next.reserve(mElements.size());
+
+        for (const size_t startPosition : mStartPositions) {
+            activate(startPosition, step, current, steps);
+        }
+
+        for (size_t i = 0; i < atr.size() * 2 && !current.empty(); i++) {
+            const uint8_t nibble = i % 2 == 0 ? atr[i / 2] >> 4 : atr[i / 2] & 0x0F;
+
+            step++;
+            next.clear();
+
+            for (const size_t position : current) {
+                const Element& element = mElements[position];
+                switch (element.type) {
+                case ElementType::NIBBLE:
+                    if (element.nibble == nibble) {
+                        activate(position + 1, step, next, steps);
+                    }
+                    break;
+                case ElementType::ANY:
+                    activate(position + 1, step, next, steps);
+                    break;
+                case ElementType::ANY_SEQUENCE:
+                    activate(position, step, next, steps);
+                    break;
+                case ElementType::ACCEPT:
+                    break;
+                }
+            }
+
+            current.swap(next);
+        }
+
+        for (const size_t position : current) {
+            if (mElements[position].type == ElementType::ACCEPT) {
+                protocols[mElements[position].protocolId] = true;
+            }
+        }
+    }
+
+    if (!mFallbackPatterns.empty()) {
+        const std::string atrHex = HexUtil::toHex(atr);
+        for (const auto& fallbackPattern : mFallbackPatterns) {
+            protocols[fallbackPattern.first] = fallbackPattern.second->matcher(atrHex)->matches();
+        }
+    }
+}
+
+}
+}
+}
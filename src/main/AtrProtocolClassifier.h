@@ -0,0 +1,132 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+/* Keyple Core Util */
+#include "Pattern.h"
+
+namespace keyple {
+namespace plugin {
+namespace pcsc {
+
+using namespace keyple::core::util::cpp;
+
+/**
+ * (package-private)<br>
+ * Identifies in a single pass all the protocols whose rule matches an ATR.
+ *
+ * <p>The protocol rules are regular expressions applied on the ATR hex string. The rules made of
+ * letters, '.', ".*" and '|' (all the default rules) are combined into a single automaton
+ * running on the nibbles of the raw ATR, each nibble being read once whatever the number of
+ * rules. The other rules are evaluated separately with a regular expression.
+ *
+ * @since 2.2.0
+ */
+class AtrProtocolClassifier final {
+public:
+    /**
+     * (package-private)<br>
+     * Compiles the provided rules.
+     *
+     * @param protocolRules The protocol rules, the identifier of a protocol being the index of its
+     *     rule. An empty rule never matches.
+     * @since 2.2.0
+     */
+    explicit AtrProtocolClassifier(const std::vector<std::string>& protocolRules);
+
+    /**
+     * (package-private)<br>
+     * Identifies the protocols matching the provided ATR.
+     *
+     * @param atr The ATR.
+     * @param protocols Set to one flag per protocol, true if the rule of the protocol matches.
+     * @since 2.2.0
+     */
+    void classify(const std::vector<uint8_t>& atr, std::vector<bool>& protocols) const;
+
+private:
+    /**
+     * Automaton element types.
+     */
+    enum class ElementType : uint8_t {
+        /* Matches a given nibble */
+        NIBBLE,
+        /* Matches any nibble ('.') */
+        ANY,
+        /* Matches any sequence of nibbles (".*") */
+        ANY_SEQUENCE,
+        /* End of an alternative of a rule */
+        ACCEPT
+    };
+
+    /**
+     * Value of a NIBBLE element that matches no nibble.
+     */
+    static const uint8_t NO_NIBBLE;
+
+    /**
+     *
+     */
+    struct Element {
+        ElementType type;
+        uint8_t nibble;
+        int protocolId;
+    };
+
+    /**
+     *
+     */
+    const size_t mProtocolCount;
+
+    /**
+     * The alternatives of the combined rules, one after the other, each one ended by an ACCEPT
+     * element.
+     */
+    std::vector<Element> mElements;
+
+    /**
+     * Position of the first element of each alternative.
+     */
+    std::vector<size_t> mStartPositions;
+
+    /**
+     * The rules evaluated with a regular expression.
+     */
+    std::vector<std::pair<int, std::shared_ptr<Pattern>>> mFallbackPatterns;
+
+    /**
+     * Appends the elements of the alternatives of a rule.
+     *
+     * @return False if the rule uses a construct not supported by the automaton.
+     */
+    bool compile(const int protocolId, const std::string& protocolRule);
+
+    /**
+     * Activates for the provided step the provided position and the ones reachable from it without
+     * reading a nibble.
+     */
+    void activate(size_t position,
+                  const size_t step,
+                  std::vector<size_t>& positions,
+                  std::vector<size_t>& steps) const;
+};
+
+}
+}
+}
@@ -0,0 +1,349 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include "CardFarmAdapter.h"
+
+#include <chrono>
+
+/* Keyple Core Util */
+#include "Exception.h"
+#include "IllegalStateException.h"
+
+namespace keyple {
+namespace plugin {
+namespace pcsc {
+
+using namespace keyple::core::util::cpp::exception;
+
+const long CardFarmAdapter::POLLING_PERIOD_MS = 100;
+
+CardFarmAdapter::CardFarmAdapter(
+  const std::vector<std::shared_ptr<AbstractPcscReaderAdapter>>& readers,
+  const bool isCardRemovalAwaited)
+: mIsCardRemovalAwaited(isCardRemovalAwaited),
+  mIsRunning(true),
+  mQueuedJobCount(0),
+  mPendingJobCount(0)
+{
+    for (const auto& reader : readers) {
+        std::unique_ptr<Worker> worker(new Worker());
+        worker->reader = reader;
+        worker->executedJobCount = 0;
+        worker->stolenJobCount = 0;
+        mWorkers.push_back(std::move(worker));
+    }
+
+    /* Started once all the workers exist, as they may steal from each other */
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (const auto& worker : mWorkers) {
+        worker->thread = std::thread(&CardFarmAdapter::run, this, worker.get());
+        worker->threadId = worker->thread.get_id();
+    }
+}
+
+CardFarmAdapter::~CardFarmAdapter()
+{
+    stop();
+}
+
+void CardFarmAdapter::destroy(CardFarmAdapter* farm,
+                              const std::weak_ptr<TaskExecutor>& teardownExecutor)
+{
+    if (!farm->isWorkerThread()) {
+        delete farm;
+        return;
+    }
+
+    /* The other workers stop meanwhile, the current one once its job or callback returns */
+    farm->stop();
+
+    const std::shared_ptr<TaskExecutor> executor = teardownExecutor.lock();
+    if (executor != nullptr) {
+        executor->execute([farm]() { delete farm; });
+        return;
+    }
+
+    farm->mLogger->warn("card farm released after the plugin, deleted on a detached thread\n");
+    std::thread([farm]() { delete farm; }).detach();
+}
+
+void CardFarmAdapter::submit(const CardJob& job, const CardJobCallback& callback)
+{
+    if (!mIsRunning) {
+        throw IllegalStateException("The card farm is stopped");
+    }
+
+    /* The shortest queue, the idle workers steal from the longest ones anyway */
+    Worker* target = nullptr;
+    size_t shortest = 0;
+    for (const auto& worker : mWorkers) {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        if (target == nullptr || worker->jobs.size() < shortest) {
+            target = worker.get();
+            shortest = worker->jobs.size();
+        }
+    }
+
+    if (target == nullptr) {
+        throw IllegalStateException("The card farm has no reader");
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    /* Checked again under the lock, a concurrent stop call then discards the job and counts it */
+    if (!mIsRunning) {
+        throw IllegalStateException("The card farm is stopped");
+    }
+
+    {
+        std::lock_guard<std::mutex> targetLock(target->mutex);
+        target->jobs.push_back({job, callback});
+    }
+
+    mQueuedJobCount++;
+    mPendingJobCount++;
+    mCondition.notify_all();
+}
+
+void CardFarmAdapter::waitForCompletion()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    mCondition.wait(lock, [this]() { return !mIsRunning || mPendingJobCount == 0; });
+}
+
+void CardFarmAdapter::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        mIsRunning = false;
+        mCondition.notify_all();
+    }
+
+    /*
+     * Called from a job or a callback, the worker can not join itself (nor be joined while it
+     * waits here): the workers are joined by the next stop call from another thread, at the
+     * latest when the farm is destroyed
+     */
+    if (!isWorkerThread()) {
+        std::lock_guard<std::mutex> lock(mJoinMutex);
+
+        for (const auto& worker : mWorkers) {
+            if (worker->thread.joinable()) {
+                worker->thread.join();
+            }
+        }
+    }
+
+    size_t discardedJobCount = 0;
+    for (const auto& worker : mWorkers) {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        discardedJobCount += worker->jobs.size();
+        worker->jobs.clear();
+    }
+
+    if (discardedJobCount > 0) {
+        mLogger->debug("card farm stopped, % queued job(s) discarded\n", discardedJobCount);
+    }
+
+    /* The jobs being run, if any, are still pending */
+    std::lock_guard<std::mutex> lock(mMutex);
+    mQueuedJobCount -= discardedJobCount;
+    mPendingJobCount -= discardedJobCount;
+    mCondition.notify_all();
+}
+
+bool CardFarmAdapter::isWorkerThread()
+{
+    const std::thread::id currentThreadId = std::this_thread::get_id();
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    for (const auto& worker : mWorkers) {
+        if (worker->threadId == currentThreadId) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+const std::vector<PcscCardFarm::ReaderStatistics> CardFarmAdapter::getStatistics() const
+{
+    std::vector<ReaderStatistics> statistics;
+
+    for (const auto& worker : mWorkers) {
+        ReaderStatistics readerStatistics;
+        readerStatistics.readerName = worker->reader->getName();
+        readerStatistics.executedJobCount = worker->executedJobCount;
+        readerStatistics.stolenJobCount = worker->stolenJobCount;
+
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        readerStatistics.queuedJobCount = worker->jobs.size();
+
+        statistics.push_back(readerStatistics);
+    }
+
+    return statistics;
+}
+
+void CardFarmAdapter::run(Worker* worker)
+{
+    const std::shared_ptr<AbstractPcscReaderAdapter>& reader = worker->reader;
+
+    mLogger->trace("%: card farm worker started\n", reader->getName());
+
+    while (mIsRunning) {
+        if (!waitForCardPresence(reader, true)) {
+            continue;
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            if (!mCondition.wait_for(lock,
+                                     std::chrono::milliseconds(POLLING_PERIOD_MS),
+                                     [this]() { return !mIsRunning || mQueuedJobCount > 0; }) ||
+                !mIsRunning) {
+                continue;
+            }
+        }
+
+        QueuedJob queuedJob;
+        if (!takeJob(worker, queuedJob)) {
+            /* Taken by another worker meanwhile */
+            continue;
+        }
+
+        execute(worker, queuedJob);
+
+        if (mIsCardRemovalAwaited) {
+            while (mIsRunning && !waitForCardPresence(reader, false)) {
+            }
+        }
+    }
+
+    mLogger->trace("%: card farm worker stopped\n", reader->getName());
+}
+
+bool CardFarmAdapter::waitForCardPresence(
+    const std::shared_ptr<AbstractPcscReaderAdapter>& reader, const bool present)
+{
+    try {
+        return reader->waitForCardPresence(present, POLLING_PERIOD_MS) ==
+               CardPresenceTracker::WaitResult::REACHED;
+    } catch (const Exception& e) {
+        mLogger->debug("%: card presence unavailable: %\n", reader->getName(), e);
+    }
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCondition.wait_for(lock,
+                        std::chrono::milliseconds(POLLING_PERIOD_MS),
+                        [this]() { return !mIsRunning; });
+
+    return false;
+}
+
+bool CardFarmAdapter::takeJob(Worker* worker, QueuedJob& queuedJob)
+{
+    bool isTaken = false;
+
+    {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        if (!worker->jobs.empty()) {
+            queuedJob = std::move(worker->jobs.front());
+            worker->jobs.pop_front();
+            isTaken = true;
+        }
+    }
+
+    if (!isTaken) {
+        Worker* victim = nullptr;
+        size_t longest = 0;
+        for (const auto& other : mWorkers) {
+            if (other.get() == worker) {
+                continue;
+            }
+
+            std::lock_guard<std::mutex> lock(other->mutex);
+            if (other->jobs.size() > longest) {
+                victim = other.get();
+                longest = other->jobs.size();
+            }
+        }
+
+        if (victim != nullptr) {
+            /* The back of the queue, the owner takes from the front */
+            std::lock_guard<std::mutex> lock(victim->mutex);
+            if (!victim->jobs.empty()) {
+                queuedJob = std::move(victim->jobs.back());
+                victim->jobs.pop_back();
+                worker->stolenJobCount++;
+                isTaken = true;
+            }
+        }
+    }
+
+    if (isTaken) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mQueuedJobCount--;
+    }
+
+    return isTaken;
+}
+
+void CardFarmAdapter::execute(Worker* worker, const QueuedJob& queuedJob)
+{
+    AbstractPcscReaderAdapter& reader = *worker->reader;
+    std::exception_ptr error;
+    bool isChannelOpenedByJob = false;
+
+    try {
+        if (!reader.isPhysicalChannelOpen()) {
+            reader.openPhysicalChannel();
+            isChannelOpenedByJob = true;
+        }
+
+        queuedJob.job(reader);
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    if (isChannelOpenedByJob) {
+        try {
+            reader.closePhysicalChannel();
+        } catch (const Exception& e) {
+            mLogger->error("%: error while closing physical channel: %\n", reader.getName(), e);
+        }
+    }
+
+    worker->executedJobCount++;
+
+    if (queuedJob.callback) {
+        try {
+            queuedJob.callback(reader.getName(), error);
+        } catch (const std::exception& e) {
+            mLogger->error("%: card job callback failed: %\n", reader.getName(), e.what());
+        } catch (...) {
+            mLogger->error("%: card job callback failed with an unknown exception\n",
+                           reader.getName());
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mPendingJobCount--;
+    mCondition.notify_all();
+}
+
+}
+}
+}
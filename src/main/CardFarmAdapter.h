@@ -0,0 +1,221 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <typeinfo>
+#include <vector>
+
+/* Keyple Plugin Pcsc */
+#include "AbstractPcscReaderAdapter.h"
+#include "PcscCardFarm.h"
+#include "TaskExecutor.h"
+
+/* Keyple Core Util */
+#include "LoggerFactory.h"
+
+namespace keyple {
+namespace plugin {
+namespace pcsc {
+
+using namespace keyple::core::util::cpp;
+
+/**
+ * (package-private)<br>
+ * Implementation of PcscCardFarm relying on the card presence notified to the readers by the
+ * plugin monitor.
+ *
+ * @since 2.2.0
+ */
+class CardFarmAdapter final : public PcscCardFarm {
+public:
+    /**
+     * (package-private)<br>
+     * Creates the farm and starts a worker per reader.
+     *
+     * @param readers The readers, each one appearing once.
+     * @param isCardRemovalAwaited true to wait for the removal of the card after each job, so
+     *     that each card is processed once.
+     * @since 2.2.0
+     */
+    CardFarmAdapter(const std::vector<std::shared_ptr<AbstractPcscReaderAdapter>>& readers,
+                    const bool isCardRemovalAwaited);
+
+    /**
+     * Stops the workers.
+     */
+    ~CardFarmAdapter();
+
+    /**
+     * (package-private)<br>
+     * Deleter of the farms handed out by the plugin.
+     *
+     * <p>When the last reference is released by a job or a callback, the farm is stopped and then
+     * deleted by the provided executor of the plugin, a worker being unable to join itself. The
+     * plugin waits for these deletions when destroyed. A farm released this way after the plugin
+     * is deleted on a detached thread.
+     *
+     * @param farm The farm to destroy.
+     * @param teardownExecutor The executor deleting the farms released by their workers.
+     * @since 2.2.0
+     */
+    static void destroy(CardFarmAdapter* farm, const std::weak_ptr<TaskExecutor>& teardownExecutor);
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.0
+     */
+    void submit(const CardJob& job, const CardJobCallback& callback) override;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.0
+     */
+    void waitForCompletion() override;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.0
+     */
+    void stop() override;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.0
+     */
+    const std::vector<ReaderStatistics> getStatistics() const override;
+
+private:
+    /**
+     *
+     */
+    struct QueuedJob {
+        CardJob job;
+        CardJobCallback callback;
+    };
+
+    /**
+     * Reader of the farm, with its queue and its thread.
+     */
+    struct Worker {
+        std::shared_ptr<AbstractPcscReaderAdapter> reader;
+        mutable std::mutex mutex;
+        std::deque<QueuedJob> jobs;
+        std::thread thread;
+        std::thread::id threadId;
+        std::atomic<uint64_t> executedJobCount;
+        std::atomic<uint64_t> stolenJobCount;
+    };
+
+    /**
+     * Period of the checks of the stop request while waiting for a card or a job.
+     */
+    static const long POLLING_PERIOD_MS;
+
+    /**
+     *
+     */
+    const std::unique_ptr<Logger> mLogger = LoggerFactory::getLogger(typeid(CardFarmAdapter));
+
+    /**
+     *
+     */
+    const bool mIsCardRemovalAwaited;
+
+    /**
+     *
+     */
+    std::vector<std::unique_ptr<Worker>> mWorkers;
+
+    /**
+     *
+     */
+    std::atomic<bool> mIsRunning;
+
+    /**
+     * Guards the job counters and the worker thread ids.
+     */
+    std::mutex mMutex;
+
+    /**
+     * Serializes the joins of the worker threads.
+     */
+    std::mutex mJoinMutex;
+
+    /**
+     * Notified when a job is queued or completed, and when the farm is stopped.
+     */
+    std::condition_variable mCondition;
+
+    /**
+     * Jobs queued and not taken by a worker yet.
+     */
+    size_t mQueuedJobCount;
+
+    /**
+     * Jobs submitted and not completed yet.
+     */
+    size_t mPendingJobCount;
+
+    /**
+     * (private)<br>
+     * Worker thread body.
+     */
+    void run(Worker* worker);
+
+    /**
+     * (private)<br>
+     * Waits up to POLLING_PERIOD_MS for the card presence of a reader.
+     *
+     * <p>If the card presence is unavailable (reader failure), waits for the same period before
+     * returning, the monitor recovering by itself.
+     *
+     * @return True if the expected presence was reached.
+     */
+    bool waitForCardPresence(const std::shared_ptr<AbstractPcscReaderAdapter>& reader,
+                             const bool present);
+
+    /**
+     * (private)<br>
+     * Takes the job at the front of the queue of the worker or, if empty, steals the job at the
+     * back of the longest queue.
+     *
+     * @return false if no job is queued.
+     */
+    bool takeJob(Worker* worker, QueuedJob& queuedJob);
+
+    /**
+     * (private)<br>
+     * Runs a job on the card of the worker and notifies its completion.
+     */
+    void execute(Worker* worker, const QueuedJob& queuedJob);
+
+    /**
+     * (private)<br>
+     * Tells if the calling thread is a worker of the farm (i.e. runs a job or a callback).
+     */
+    bool isWorkerThread();
+};
+
+}
+}
+}
@@ -0,0 +1,149 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include "PcscAutonomousPluginAdapter.h"
+
+/* Keyple Core Util */
+#include "KeypleStd.h"
+
+namespace keyple {
+namespace plugin {
+namespace pcsc {
+
+PcscAutonomousPluginAdapter::PcscAutonomousPluginAdapter(
+  std::shared_ptr<AbstractPcscPluginAdapter> pluginAdapter)
+: mPluginAdapter(pluginAdapter), mAutonomousObservablePluginApi(nullptr) {}
+
+const std::string& PcscAutonomousPluginAdapter::getName() const
+{
+    return mPluginAdapter->getName();
+}
+
+const std::vector<std::shared_ptr<ReaderSpi>> PcscAutonomousPluginAdapter::searchAvailableReaders()
+{
+    const std::vector<std::shared_ptr<ReaderSpi>> readerSpis =
+        mPluginAdapter->searchAvailableReaders();
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    mReaderNames.clear();
+    for (const auto& readerSpi : readerSpis) {
+        mReaderNames.insert(readerSpi->getName());
+    }
+
+    return readerSpis;
+}
+
+void PcscAutonomousPluginAdapter::onUnregister()
+{
+    mPluginAdapter->getCardTerminalMonitor()->setTerminalListListener(nullptr);
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mAutonomousObservablePluginApi = nullptr;
+    }
+
+    mPluginAdapter->onUnregister();
+}
+
+void PcscAutonomousPluginAdapter::connect(
+    AutonomousObservablePluginApi* autonomousObservablePluginApi)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mAutonomousObservablePluginApi = autonomousObservablePluginApi;
+    }
+
+    mLogger->trace("%: start monitoring the reader list\n", getName());
+
+    mPluginAdapter->getCardTerminalMonitor()->setTerminalListListener(shared_from_this());
+}
+
+void PcscAutonomousPluginAdapter::onTerminalListChanged(
+    const std::vector<std::string>& terminalNames)
+{
+    std::vector<std::shared_ptr<ReaderSpi>> connectedReaders;
+    std::vector<std::string> disconnectedReaderNames;
+    AutonomousObservablePluginApi* api = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        if (mAutonomousObservablePluginApi == nullptr) {
+            return;
+        }
+
+        api = mAutonomousObservablePluginApi;
+
+        const std::set<std::string> names(terminalNames.begin(), terminalNames.end());
+
+        for (const auto& name : names) {
+            if (mReaderNames.find(name) == mReaderNames.end()) {
+                connectedReaders.push_back(
+                    mPluginAdapter->createReader(std::make_shared<CardTerminal>(name)));
+            }
+        }
+
+        for (const auto& name : mReaderNames) {
+            if (names.find(name) == names.end()) {
+                disconnectedReaderNames.push_back(name);
+            }
+        }
+
+        mReaderNames = names;
+    }
+
+    if (!connectedReaders.empty()) {
+        mLogger->trace("%: readers connected %\n", getName(), connectedReaders);
+        api->onReaderConnected(connectedReaders);
+    }
+
+    if (!disconnectedReaderNames.empty()) {
+        mLogger->trace("%: readers disconnected %\n", getName(), disconnectedReaderNames);
+        api->onReaderDisconnected(disconnectedReaderNames);
+    }
+}
+
+const std::vector<PcscPlugin::ReaderJobResult> PcscAutonomousPluginAdapter::runOnReaders(
+    const std::vector<std::shared_ptr<PcscReader>>& readers,
+    const ReaderJob& job,
+    const bool openPhysicalChannel,
+    const bool synchronizedStart)
+{
+    return mPluginAdapter->runOnReaders(readers, job, openPhysicalChannel, synchronizedStart);
+}
+
+const std::vector<PcscPlugin::ReaderJobResult> PcscAutonomousPluginAdapter::broadcastApdus(
+    const std::vector<std::shared_ptr<PcscReader>>& readers,
+    const std::vector<PcscReader::BatchApdu>& apdus,
+    std::vector<PcscReader::BatchResponse>& batchResponses,
+    const bool synchronizedStart)
+{
+    return mPluginAdapter->broadcastApdus(readers, apdus, batchResponses, synchronizedStart);
+}
+
+std::shared_ptr<PcscCardFarm> PcscAutonomousPluginAdapter::createCardFarm(
+    const std::vector<std::shared_ptr<PcscReader>>& readers, const bool waitForCardRemoval)
+{
+    return mPluginAdapter->createCardFarm(readers, waitForCardRemoval);
+}
+
+std::shared_ptr<PcscSamPool> PcscAutonomousPluginAdapter::createSamPool(
+    const std::vector<std::shared_ptr<PcscReader>>& readers,
+    const PcscSamPool::SelectionPolicy selectionPolicy)
+{
+    return mPluginAdapter->createSamPool(readers, selectionPolicy);
+}
+
+}
+}
+}
@@ -0,0 +1,182 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+/* Keyple Core Util */
+#include "LoggerFactory.h"
+
+/* Keyple Core Plugin */
+#include "AutonomousObservablePluginApi.h"
+#include "AutonomousObservablePluginSpi.h"
+
+/* Keyple Plugin Pcsc */
+#include "AbstractPcscPluginAdapter.h"
+#include "PcscPlugin.h"
+#include "TerminalListListener.h"
+
+namespace keyple {
+namespace plugin {
+namespace pcsc {
+
+using namespace keyple::core::plugin;
+using namespace keyple::core::plugin::spi;
+using namespace keyple::core::util::cpp;
+using namespace keyple::plugin::pcsc::cpp;
+
+/**
+ * (package-private)<br>
+ * Autonomous observable variant of the PC/SC plugin.
+ *
+ * <p>Instead of letting Keyple core enumerate the readers every monitoring cycle, the plugin
+ * watches the "\\?PnP?\Notification" pseudo-reader through the card terminal monitor and reports
+ * the plugged and unplugged readers as soon as PC/SC notifies them.
+ *
+ * <p>Delegates everything else to the regular plugin adapter.
+ *
+ * @since 2.2.0
+ */
+class PcscAutonomousPluginAdapter final
+: public PcscPlugin,
+  public AutonomousObservablePluginSpi,
+  public TerminalListListener,
+  public std::enable_shared_from_this<PcscAutonomousPluginAdapter> {
+public:
+    /**
+     * (package-private)<br>
+     * Creates an instance on top of a plugin adapter.
+     *
+     * @param pluginAdapter The plugin adapter creating the readers.
+     * @since 2.2.0
+     */
+    explicit PcscAutonomousPluginAdapter(std::shared_ptr<AbstractPcscPluginAdapter> pluginAdapter);
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.0
+     */
+    const std::string& getName() const override;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.0
+     */
+    const std::vector<std::shared_ptr<ReaderSpi>> searchAvailableReaders() override;
+
+    /**
+     * {@inheritDoc}
+     *
+     * <p>Stops monitoring the list of readers.
+     *
+     * @since 2.2.0
+     */
+    void onUnregister() override;
+
+    /**
+     * {@inheritDoc}
+     *
+     * <p>Starts monitoring the list of readers.
+     *
+     * @since 2.2.0
+     */
+    void connect(AutonomousObservablePluginApi* autonomousObservablePluginApi) override;
+
+    /**
+     * {@inheritDoc}
+     *
+     * <p>Notifies Keyple core of the readers connected or disconnected since the last
+     * notification.
+     *
+     * @since 2.2.0
+     */
+    void onTerminalListChanged(const std::vector<std::string>& terminalNames) override;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.0
+     */
+    const std::vector<ReaderJobResult> runOnReaders(
+        const std::vector<std::shared_ptr<PcscReader>>& readers,
+        const ReaderJob& job,
+        const bool openPhysicalChannel,
+        const bool synchronizedStart) override;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.0
+     */
+    const std::vector<ReaderJobResult> broadcastApdus(
+        const std::vector<std::shared_ptr<PcscReader>>& readers,
+        const std::vector<PcscReader::BatchApdu>& apdus,
+        std::vector<PcscReader::BatchResponse>& batchResponses,
+        const bool synchronizedStart) override;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.0
+     */
+    std::shared_ptr<PcscCardFarm> createCardFarm(
+        const std::vector<std::shared_ptr<PcscReader>>& readers,
+        const bool waitForCardRemoval) override;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.0
+     */
+    std::shared_ptr<PcscSamPool> createSamPool(
+        const std::vector<std::shared_ptr<PcscReader>>& readers,
+        const PcscSamPool::SelectionPolicy selectionPolicy) override;
+
+private:
+    /**
+     *
+     */
+    const std::unique_ptr<Logger> mLogger =
+        LoggerFactory::getLogger(typeid(PcscAutonomousPluginAdapter));
+
+    /**
+     *
+     */
+    const std::shared_ptr<AbstractPcscPluginAdapter> mPluginAdapter;
+
+    /**
+     *
+     */
+    AutonomousObservablePluginApi* mAutonomousObservablePluginApi;
+
+    /**
+     * Names of the readers known by Keyple core.
+     */
+    std::set<std::string> mReaderNames;
+
+    /**
+     *
+     */
+    std::mutex mMutex;
+};
+
+}
+}
+}
@@ -0,0 +1,189 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include "PcscAutonomousReaderAdapter.h"
+
+/* Keyple Core Util */
+#include "Exception.h"
+
+namespace keyple {
+namespace plugin {
+namespace pcsc {
+
+using namespace keyple::core::util::cpp::exception;
+
+/* CARD EVENT FORWARDER ------------------------------------------------------------------------- */
+
+PcscAutonomousReaderAdapter::CardEventForwarder::CardEventForwarder(
+  const std::string& readerName, std::shared_ptr<TaskExecutor> executor)
+: mReaderName(readerName),
+  mExecutor(executor),
+  mIsScheduled(false),
+  mIsInsertionNotified(false),
+  mIsDelivering(false),
+  mInsertionApi(nullptr),
+  mRemovalApi(nullptr)
+{
+    mExecutor->reserveThread();
+}
+
+PcscAutonomousReaderAdapter::CardEventForwarder::~CardEventForwarder()
+{
+    mExecutor->releaseThread();
+}
+
+void PcscAutonomousReaderAdapter::CardEventForwarder::onCardInserted(
+    const std::vector<uint8_t>& atr)
+{
+    (void)atr;
+
+    push(true);
+}
+
+void PcscAutonomousReaderAdapter::CardEventForwarder::onCardRemoved()
+{
+    push(false);
+}
+
+void PcscAutonomousReaderAdapter::CardEventForwarder::setInsertionApi(
+    WaitForCardInsertionAutonomousReaderApi* api)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mInsertionApi = api;
+}
+
+void PcscAutonomousReaderAdapter::CardEventForwarder::setRemovalApi(
+    WaitForCardRemovalAutonomousReaderApi* api)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mRemovalApi = api;
+}
+
+void PcscAutonomousReaderAdapter::CardEventForwarder::detach()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mEvents.clear();
+    mInsertionApi = nullptr;
+    mRemovalApi = nullptr;
+
+    /* The reader may be destroyed by Keyple core while processing the event */
+    if (mIsDelivering && mDeliveryThreadId != std::this_thread::get_id()) {
+        mDeliveryCondition.wait(lock, [this]() { return !mIsDelivering; });
+    }
+}
+
+void PcscAutonomousReaderAdapter::CardEventForwarder::push(const bool inserted)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        mEvents.push_back(inserted);
+
+        if (mIsScheduled) {
+            return;
+        }
+
+        mIsScheduled = true;
+    }
+
+    /* The task keeps the forwarder alive until it has been executed */
+    const std::shared_ptr<CardEventForwarder> self = shared_from_this();
+    mExecutor->execute([self]() { self->deliver(); });
+}
+
+void PcscAutonomousReaderAdapter::CardEventForwarder::deliver()
+{
+    while (true) {
+        WaitForCardInsertionAutonomousReaderApi* insertionApi = nullptr;
+        WaitForCardRemovalAutonomousReaderApi* removalApi = nullptr;
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            if (mEvents.empty()) {
+                mIsScheduled = false;
+                return;
+            }
+
+            const bool inserted = mEvents.front();
+            mEvents.pop_front();
+
+            if (inserted) {
+                insertionApi = mInsertionApi;
+                mIsInsertionNotified = insertionApi != nullptr;
+            } else if (mIsInsertionNotified) {
+                /* A removal is only meaningful to Keyple core after an insertion */
+                removalApi = mRemovalApi;
+                mIsInsertionNotified = false;
+            }
+
+            mIsDelivering = insertionApi != nullptr || removalApi != nullptr;
+            mDeliveryThreadId = std::this_thread::get_id();
+        }
+
+        /* Keyple core processes the card from within these calls */
+        try {
+            if (insertionApi != nullptr) {
+                mLogger->trace("%: card inserted\n", mReaderName);
+                insertionApi->onCardInserted();
+            } else if (removalApi != nullptr) {
+                mLogger->trace("%: card removed\n", mReaderName);
+                removalApi->onCardRemoved();
+            }
+        } catch (const Exception& e) {
+            mLogger->error("%: error while notifying a card event: %\n", mReaderName, e);
+        } catch (...) {
+            mLogger->error("%: unknown error while notifying a card event\n", mReaderName);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mIsDelivering = false;
+        }
+
+        mDeliveryCondition.notify_all();
+    }
+}
+
+/* READER --------------------------------------------------------------------------------------- */
+
+PcscAutonomousReaderAdapter::PcscAutonomousReaderAdapter(
+  std::shared_ptr<CardTerminal> terminal, std::shared_ptr<AbstractPcscPluginAdapter> pluginAdapter)
+: AbstractPcscReaderAdapter(terminal, pluginAdapter),
+  mCardEventForwarder(
+      std::make_shared<CardEventForwarder>(terminal->getName(),
+                                           pluginAdapter->getCardEventExecutor()))
+{
+    setCardPresenceListener(mCardEventForwarder);
+}
+
+PcscAutonomousReaderAdapter::~PcscAutonomousReaderAdapter()
+{
+    setCardPresenceListener(nullptr);
+    mCardEventForwarder->detach();
+}
+
+void PcscAutonomousReaderAdapter::connect(
+    WaitForCardInsertionAutonomousReaderApi* waitForCardInsertionAutonomousReaderApi)
+{
+    mCardEventForwarder->setInsertionApi(waitForCardInsertionAutonomousReaderApi);
+}
+
+void PcscAutonomousReaderAdapter::connect(
+    WaitForCardRemovalAutonomousReaderApi* waitForCardRemovalAutonomousReaderApi)
+{
+    mCardEventForwarder->setRemovalApi(waitForCardRemovalAutonomousReaderApi);
+}
+
+}
+}
+}
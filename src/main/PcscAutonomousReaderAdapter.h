@@ -0,0 +1,231 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <typeinfo>
+
+/* Keyple Plugin Pcsc */
+#include "AbstractPcscReaderAdapter.h"
+#include "CardPresenceListener.h"
+#include "TaskExecutor.h"
+
+/* Keyple Core Plugin */
+#include "WaitForCardInsertionAutonomousReaderApi.h"
+#include "WaitForCardInsertionAutonomousSpi.h"
+#include "WaitForCardRemovalAutonomousReaderApi.h"
+#include "WaitForCardRemovalAutonomousSpi.h"
+
+/* Keyple Core Util */
+#include "LoggerFactory.h"
+
+namespace keyple {
+namespace plugin {
+namespace pcsc {
+
+using namespace keyple::core::plugin::spi::reader::observable::state::insertion;
+using namespace keyple::core::plugin::spi::reader::observable::state::removal;
+using namespace keyple::core::util::cpp;
+using namespace keyple::plugin::pcsc::cpp;
+
+/**
+ * (package-private)<br>
+ * Implementation of AbstractPcscReaderAdapter notifying the card insertion and removal by itself.
+ *
+ * <p>No thread is dedicated to this reader: the card presence changes are detected by the
+ * CardTerminalMonitor shared by all the readers of the plugin, then delivered to Keyple core by the
+ * card event executor of the plugin. The events of a reader are delivered one at a time and in the
+ * order they occurred.
+ *
+ * @since 2.2.0
+ */
+class PcscAutonomousReaderAdapter final
+: public AbstractPcscReaderAdapter,
+  public WaitForCardInsertionAutonomousSpi,
+  public WaitForCardRemovalAutonomousSpi {
+public:
+    /**
+     * (package-private)<br>
+     *
+     * @since 2.2.0
+     */
+    PcscAutonomousReaderAdapter(std::shared_ptr<CardTerminal> terminal,
+                                std::shared_ptr<AbstractPcscPluginAdapter> pluginAdapter);
+
+    /**
+     *
+     */
+    virtual ~PcscAutonomousReaderAdapter();
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.0
+     */
+    void connect(WaitForCardInsertionAutonomousReaderApi* waitForCardInsertionAutonomousReaderApi)
+        override;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.0
+     */
+    void connect(WaitForCardRemovalAutonomousReaderApi* waitForCardRemovalAutonomousReaderApi)
+        override;
+
+private:
+    /**
+     * Forwards the card presence changes to Keyple core from the card event executor.
+     *
+     * <p>Lives as long as a delivery is pending, even if the reader has been destroyed meanwhile,
+     * in which case the pending events are dropped.
+     *
+     * <p>The events of a reader are delivered one at a time, by a thread it reserves in the card
+     * event executor: a reader whose card is being processed by Keyple core never delays the
+     * events of the others.
+     */
+    class CardEventForwarder final
+    : public CardPresenceListener,
+      public std::enable_shared_from_this<CardEventForwarder> {
+    public:
+        /**
+         *
+         */
+        CardEventForwarder(const std::string& readerName,
+                           std::shared_ptr<TaskExecutor> executor);
+
+        /**
+         *
+         */
+        ~CardEventForwarder();
+
+        /**
+         * {@inheritDoc}
+         */
+        void onCardInserted(const std::vector<uint8_t>& atr) override;
+
+        /**
+         * {@inheritDoc}
+         */
+        void onCardRemoved() override;
+
+        /**
+         *
+         */
+        void setInsertionApi(WaitForCardInsertionAutonomousReaderApi* api);
+
+        /**
+         *
+         */
+        void setRemovalApi(WaitForCardRemovalAutonomousReaderApi* api);
+
+        /**
+         * Drops the pending events and forgets the Keyple core APIs.
+         *
+         * <p>Waits for the end of the event being delivered, if any, so that the APIs are no
+         * longer used once it returns. Does not wait if called from the delivery itself.
+         */
+        void detach();
+
+    private:
+        /**
+         *
+         */
+        const std::unique_ptr<Logger> mLogger =
+            LoggerFactory::getLogger(typeid(CardEventForwarder));
+
+        /**
+         *
+         */
+        const std::string mReaderName;
+
+        /**
+         *
+         */
+        const std::shared_ptr<TaskExecutor> mExecutor;
+
+        /**
+         *
+         */
+        std::mutex mMutex;
+
+        /**
+         * Pending events, true for an insertion, false for a removal.
+         */
+        std::deque<bool> mEvents;
+
+        /**
+         * True while a delivery task is queued or running.
+         */
+        bool mIsScheduled;
+
+        /**
+         * True if the last delivered event is an insertion.
+         */
+        bool mIsInsertionNotified;
+
+        /**
+         * True while an API is being called, by the thread mDeliveryThreadId.
+         */
+        bool mIsDelivering;
+
+        /**
+         *
+         */
+        std::thread::id mDeliveryThreadId;
+
+        /**
+         * Notified at the end of each API call.
+         */
+        std::condition_variable mDeliveryCondition;
+
+        /**
+         *
+         */
+        WaitForCardInsertionAutonomousReaderApi* mInsertionApi;
+
+        /**
+         *
+         */
+        WaitForCardRemovalAutonomousReaderApi* mRemovalApi;
+
+        /**
+         *
+         */
+        void push(const bool inserted);
+
+        /**
+         * Delivers the pending events, executed by the card event executor.
+         */
+        void deliver();
+    };
+
+    /**
+     *
+     */
+    const std::unique_ptr<Logger> mLogger =
+        LoggerFactory::getLogger(typeid(PcscAutonomousReaderAdapter));
+
+    /**
+     *
+     */
+    const std::shared_ptr<CardEventForwarder> mCardEventForwarder;
+};
+
+}
+}
+}
@@ -0,0 +1,142 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <string>
+#include <vector>
+
+/* Keyple Plugin Pcsc */
+#include "KeyplePluginPcscExport.h"
+#include "PcscReader.h"
+
+namespace keyple {
+namespace plugin {
+namespace pcsc {
+
+/**
+ * Set of PC/SC readers processing a stream of independent card jobs (e.g. personalizing one card),
+ * created by PcscPlugin::createCardFarm.
+ *
+ * <p>Each reader has a worker thread and a queue of jobs. A worker only takes a job when a card is
+ * present in its reader, from the front of its own queue or, if empty, from the back of the
+ * longest queue of the other readers. The jobs thus flow to the readers holding a ready card,
+ * whatever the time taken by each card.
+ *
+ * <p>The physical channel is opened before each job and closed after it. The readers must not be
+ * used by anything else while they belong to the farm.
+ *
+ * @since 2.2.0
+ */
+class KEYPLEPLUGINPCSC_API PcscCardFarm {
+public:
+    /**
+     * Job run on a reader holding a card, the physical channel being open.
+     *
+     * @since 2.2.0
+     */
+    typedef std::function<void(PcscReader& reader)> CardJob;
+
+    /**
+     * Invoked once a job has completed, from the worker thread of the reader.
+     *
+     * <p>Receives the name of the reader and the exception thrown by the job or by the opening of
+     * the physical channel, null if the job succeeded.
+     *
+     * @since 2.2.0
+     */
+    typedef std::function<void(const std::string& readerName, std::exception_ptr error)>
+        CardJobCallback;
+
+    /**
+     * Activity of a reader of the farm.
+     *
+     * @since 2.2.0
+     */
+    struct KEYPLEPLUGINPCSC_API ReaderStatistics {
+        /**
+         * The reader name.
+         *
+         * @since 2.2.0
+         */
+        std::string readerName;
+
+        /**
+         * The number of jobs executed by the reader, successfully or not.
+         *
+         * @since 2.2.0
+         */
+        uint64_t executedJobCount = 0;
+
+        /**
+         * The number of jobs executed by the reader taken from the queue of another reader.
+         *
+         * @since 2.2.0
+         */
+        uint64_t stolenJobCount = 0;
+
+        /**
+         * The number of jobs currently queued for the reader.
+         *
+         * @since 2.2.0
+         */
+        size_t queuedJobCount = 0;
+    };
+
+    /**
+     * Stops the farm, see stop.
+     */
+    virtual ~PcscCardFarm() = default;
+
+    /**
+     * Queues a job, on the reader with the shortest queue.
+     *
+     * @param job The job.
+     * @param callback The callback invoked once the job has completed (optional).
+     * @throw IllegalStateException If the farm is stopped.
+     * @since 2.2.0
+     */
+    virtual void submit(const CardJob& job, const CardJobCallback& callback = nullptr) = 0;
+
+    /**
+     * Blocks until all the submitted jobs have completed or the farm is stopped.
+     *
+     * @since 2.2.0
+     */
+    virtual void waitForCompletion() = 0;
+
+    /**
+     * Stops the workers once their current job is completed, the queued jobs are discarded
+     * without invoking their callback.
+     *
+     * <p>May be called from a job or a callback: it then returns without waiting for the workers.
+     * The farm may as well be released from a job or a callback.
+     *
+     * @since 2.2.0
+     */
+    virtual void stop() = 0;
+
+    /**
+     * Gets the activity of each reader.
+     *
+     * @return The statistics, in the order of the readers provided when creating the farm.
+     * @since 2.2.0
+     */
+    virtual const std::vector<ReaderStatistics> getStatistics() const = 0;
+};
+
+}
+}
+}
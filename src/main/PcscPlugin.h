@@ -12,9 +12,20 @@
 
 #pragma once
 
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <vector>
+
 /* Keyple Core Common */
 #include "KeyplePluginExtension.h"
 
+/* Keyple Plugin Pcsc */
+#include "PcscCardFarm.h"
+#include "PcscReader.h"
+#include "PcscSamPool.h"
+
 namespace keyple {
 namespace plugin {
 namespace pcsc {
@@ -29,9 +40,134 @@ using namespace keyple::core::common;
 class PcscPlugin : public KeyplePluginExtension {
 public:
     /**
-     * 
+     * Job run on each reader by runOnReaders.
+     *
+     * <p>Receives the reader and its index in the list of readers provided to runOnReaders. The
+     * exceptions thrown are reported in the result of the reader.
+     *
+     * @since 2.2.0
+     */
+    typedef std::function<void(PcscReader& reader, const size_t index)> ReaderJob;
+
+    /**
+     * Outcome of a job on a reader.
+     *
+     * @since 2.2.0
+     */
+    struct ReaderJobResult {
+        /**
+         * The exception thrown by the job or by the opening of the physical channel, null if the
+         * job succeeded.
+         *
+         * @since 2.2.0
+         */
+        std::exception_ptr error;
+
+        /**
+         * The time elapsed between the call and the start of the job (in microseconds).
+         *
+         * @since 2.2.0
+         */
+        uint64_t startTime = 0;
+
+        /**
+         * The duration of the job (in microseconds), the opening and closing of the physical
+         * channel excluded.
+         *
+         * @since 2.2.0
+         */
+        uint64_t duration = 0;
+    };
+
+    /**
+     *
+     */
+    virtual ~PcscPlugin() = default;
+
+    /**
+     * Runs a job on several readers in parallel and waits for its completion on all of them.
+     *
+     * <p>The jobs are executed by a bounded pool of threads of the plugin, one job per reader at a
+     * time. The readers must not be used by a card transaction meanwhile.
+     *
+     * <p>With a synchronized start, all the jobs wait for each other (and for the opening of all
+     * the physical channels) before starting, so that the readers start exchanging at the same
+     * time. The synchronized runs are executed one at a time.
+     *
+     * @param readers The readers, each one appearing once.
+     * @param job The job to run on each reader.
+     * @param openPhysicalChannel true to open the physical channel of the readers before the job
+     *     if not already open, and to close it afterwards.
+     * @param synchronizedStart true to start all the jobs at the same time.
+     * @return The results of the job, in the order of the readers.
+     * @throw IllegalArgumentException If a reader is null, is not a PC/SC reader or is provided
+     *     twice, or if more readers than the pool can run at once are provided with a synchronized
+     *     start.
+     * @since 2.2.0
+     */
+    virtual const std::vector<ReaderJobResult> runOnReaders(
+        const std::vector<std::shared_ptr<PcscReader>>& readers,
+        const ReaderJob& job,
+        const bool openPhysicalChannel,
+        const bool synchronizedStart) = 0;
+
+    /**
+     * Transmits the same batch of APDUs to several readers in parallel (e.g. to unlock all the
+     * SAMs of a bench), see runOnReaders and PcscReader::transmitApdus.
+     *
+     * <p>The physical channel of each reader is opened if needed, and closed afterwards if it was
+     * opened for the broadcast.
+     *
+     * @param readers The readers, each one appearing once.
+     * @param apdus The commands to transmit to each reader.
+     * @param batchResponses Receives the responses of each reader, in the order of the readers.
+     * @param synchronizedStart true to start all the transmissions at the same time.
+     * @return The results of the transmission, in the order of the readers.
+     * @throw IllegalArgumentException See runOnReaders.
+     * @since 2.2.0
+     */
+    virtual const std::vector<ReaderJobResult> broadcastApdus(
+        const std::vector<std::shared_ptr<PcscReader>>& readers,
+        const std::vector<PcscReader::BatchApdu>& apdus,
+        std::vector<PcscReader::BatchResponse>& batchResponses,
+        const bool synchronizedStart) = 0;
+
+    /**
+     * Creates a card farm processing a stream of card jobs on several readers, see {@link
+     * PcscCardFarm}.
+     *
+     * <p>The card presence of the readers is monitored by the plugin from the creation of the
+     * farm. The workers of the farm are stopped when it is released.
+     *
+     * @param readers The readers of the farm, each one appearing once.
+     * @param waitForCardRemoval true to process each card once, the reader waiting for the removal
+     *     of the card after each job, false to run the jobs as long as a card is present (e.g.
+     *     SAMs).
+     * @return A not null reference.
+     * @throw IllegalArgumentException If a reader is null, is not a PC/SC reader or is provided
+     *     twice.
+     * @since 2.2.0
+     */
+    virtual std::shared_ptr<PcscCardFarm> createCardFarm(
+        const std::vector<std::shared_ptr<PcscReader>>& readers,
+        const bool waitForCardRemoval) = 0;
+
+    /**
+     * Creates a pool of SAMs leased to the transactions, see {@link PcscSamPool}.
+     *
+     * <p>The physical channel of each SAM is opened by the pool and stays open until the pool is
+     * released. The readers should not be used outside of the leases meanwhile.
+     *
+     * @param readers The readers of the SAMs, each one appearing once.
+     * @param selectionPolicy The selection of the SAM to lease among the available ones.
+     * @return A not null reference.
+     * @throw IllegalArgumentException If a reader is null, is not a PC/SC reader or is provided
+     *     twice.
+     * @since 2.2.0
      */
-    virtual ~PcscPlugin() = default;    
+    virtual std::shared_ptr<PcscSamPool> createSamPool(
+        const std::vector<std::shared_ptr<PcscReader>>& readers,
+        const PcscSamPool::SelectionPolicy selectionPolicy) = 0;
 };
 
 }
@@ -14,6 +14,7 @@
 
 /* Keyple Plugin Pcsc */
 #include "CardTerminal.h"
+#include "PcscAutonomousReaderAdapter.h"
 #include "PcscPluginFactoryAdapter.h"
 #include "PcscReaderAdapter.h"
 
@@ -49,6 +50,11 @@ const std::vector<std::shared_ptr<CardTerminal>> PcscPluginAdapter::getCardTermi
 
 std::shared_ptr<ReaderSpi> PcscPluginAdapter::createReader(std::shared_ptr<CardTerminal> terminal)
 {
+    if (isAutonomousCardMonitoring()) {
+        return std::dynamic_pointer_cast<ReaderSpi>(
+                   std::make_shared<PcscAutonomousReaderAdapter>(terminal, shared_from_this()));
+    }
+
     return std::dynamic_pointer_cast<ReaderSpi>(
                std::make_shared<PcscReaderAdapter>(terminal, shared_from_this()));
 }
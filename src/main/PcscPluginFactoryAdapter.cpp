@@ -14,6 +14,7 @@
 
 /* Keyple Plugin Pcsc */
 #include "AbstractPcscPluginAdapter.h"
+#include "PcscAutonomousPluginAdapter.h"
 #include "PcscPluginAdapter.h"
 #include "PcscPluginFactory.h"
 
@@ -35,10 +36,16 @@ const std::string PcscPluginFactoryAdapter::PLUGIN_NAME = "PcscPlugin";
 PcscPluginFactoryAdapter::PcscPluginFactoryAdapter(
   const std::string& contactReaderIdentificationFilter,
   const std::string& contactlessReaderIdentificationFilter,
-  const std::map<std::string, std::string>& protocolRulesMap)
+  const std::map<std::string, std::string>& protocolRulesMap,
+  const bool isAutonomousReaderMonitoringEnabled,
+  const bool isAutonomousCardMonitoringEnabled,
+  std::shared_ptr<cpp::AtrDatabase> atrDatabase)
 : mContactReaderIdentificationFilter(contactReaderIdentificationFilter),
   mContactlessReaderIdentificationFilter(contactlessReaderIdentificationFilter),
-  mProtocolRulesMap(protocolRulesMap) {}
+  mProtocolRulesMap(protocolRulesMap),
+  mIsAutonomousReaderMonitoringEnabled(isAutonomousReaderMonitoringEnabled),
+  mIsAutonomousCardMonitoringEnabled(isAutonomousCardMonitoringEnabled),
+  mAtrDatabase(atrDatabase) {}
 
 const std::string& PcscPluginFactoryAdapter::getPluginApiVersion() const
 {
@@ -60,7 +67,13 @@ std::shared_ptr<PluginSpi> PcscPluginFactoryAdapter::getPlugin()
     std::shared_ptr<AbstractPcscPluginAdapter> plugin = PcscPluginAdapter::getInstance();
     plugin->setContactReaderIdentificationFilter(mContactReaderIdentificationFilter)
            .setContactlessReaderIdentificationFilter(mContactlessReaderIdentificationFilter)
-           .addProtocolRulesMap(mProtocolRulesMap);
+           .addProtocolRulesMap(mProtocolRulesMap)
+           .setAutonomousCardMonitoring(mIsAutonomousCardMonitoringEnabled)
+           .setAtrDatabase(mAtrDatabase);
+
+    if (mIsAutonomousReaderMonitoringEnabled) {
+        return std::make_shared<PcscAutonomousPluginAdapter>(plugin);
+    }
 
     return plugin;
 }
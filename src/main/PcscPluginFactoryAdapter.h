@@ -13,9 +13,11 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <string>
 
 /* Keyple Plugin Pcsc */
+#include "AtrDatabase.h"
 #include "PcscPluginFactory.h"
 
 /* Keyple Core Plugin */
@@ -51,7 +53,10 @@ public:
      */
     PcscPluginFactoryAdapter(const std::string& contactReaderIdentificationFilter,
                              const std::string& contactlessReaderIdentificationFilter,
-                             const std::map<std::string, std::string>& protocolRulesMap);
+                             const std::map<std::string, std::string>& protocolRulesMap,
+                             const bool isAutonomousReaderMonitoringEnabled,
+                             const bool isAutonomousCardMonitoringEnabled,
+                             std::shared_ptr<cpp::AtrDatabase> atrDatabase);
 
     /**
      * {@inheritDoc}
@@ -96,6 +101,21 @@ private:
      * 
      */
     const std::map<std::string, std::string> mProtocolRulesMap;
+
+    /**
+     *
+     */
+    const bool mIsAutonomousReaderMonitoringEnabled;
+
+    /**
+     *
+     */
+    const bool mIsAutonomousCardMonitoringEnabled;
+
+    /**
+     *
+     */
+    const std::shared_ptr<cpp::AtrDatabase> mAtrDatabase;
 };
 
 }
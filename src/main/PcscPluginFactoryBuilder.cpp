@@ -14,6 +14,7 @@
 
 /* Keyple Plugin Pcsc */
 #include "PcscPluginFactoryAdapter.h"
+#include "AtrDatabase.h"
 
 /* Keyple Core Util */
 #include "KeypleAssert.h"
@@ -23,12 +24,15 @@ namespace plugin {
 namespace pcsc {
 
 using namespace keyple::core::util;
+using namespace keyple::plugin::pcsc::cpp;
 
 using Builder = PcscPluginFactoryBuilder::Builder;
 
 /* BUILDER -------------------------------------------------------------------------------------- */
 
-Builder::Builder() {}
+Builder::Builder()
+: mIsAutonomousReaderMonitoringEnabled(false),
+  mIsAutonomousCardMonitoringEnabled(false) {}
 
 Builder& Builder::useContactReaderIdentificationFilter(
     const std::string contactReaderIdentificationFilter)
@@ -66,11 +70,37 @@ Builder& Builder::updateProtocolIdentificationRule(const std::string& readerProt
     return *this;
 }
 
+Builder& Builder::useAutonomousReaderMonitoring()
+{
+    mIsAutonomousReaderMonitoringEnabled = true;
+
+    return *this;
+}
+
+Builder& Builder::useAutonomousCardMonitoring()
+{
+    mIsAutonomousCardMonitoringEnabled = true;
+
+    return *this;
+}
+
+Builder& Builder::useAtrDatabase(const std::string& atrDatabasePath)
+{
+    Assert::getInstance().notEmpty(atrDatabasePath, "atrDatabasePath");
+
+    mAtrDatabase = AtrDatabase::open(atrDatabasePath);
+
+    return *this;
+}
+
 std::shared_ptr<PcscPluginFactory> PcscPluginFactoryBuilder::Builder::build()
 {
     return std::make_shared<PcscPluginFactoryAdapter>(mContactReaderIdentificationFilter,
                                                       mContactlessReaderIdentificationFilter,
-                                                      mProtocolRulesMap);
+                                                      mProtocolRulesMap,
+                                                      mIsAutonomousReaderMonitoringEnabled,
+                                                      mIsAutonomousCardMonitoringEnabled,
+                                                      mAtrDatabase);
 }
 
 /* PCSC PLUGIN FACTORY BUILDER ------------------------------------------------------------------ */
@@ -24,6 +24,10 @@ namespace keyple {
 namespace plugin {
 namespace pcsc {
 
+namespace cpp {
+class AtrDatabase;
+}
+
 /**
  * Builds instances of PcscPluginFactory from values configured by the setters.
  *
@@ -130,6 +134,65 @@ public:
         Builder& updateProtocolIdentificationRule(const std::string& readerProtocolName,
                                                   const std::string& protocolRule);
 
+        /**
+         * Makes the plugin report the connection and disconnection of readers by itself.
+         *
+         * <p>By default, Keyple core searches the available readers every monitoring cycle (1
+         * second). With this option, the plugin behaves as an autonomous observable plugin: it
+         * waits for the PC/SC "\\?PnP?\Notification" events and reports the plugged and
+         * unplugged readers within milliseconds, without any periodic enumeration.
+         *
+         * <p>If the platform does not support the PnP notification, the plugin falls back on a
+         * periodic check of the reader list performed by its own monitoring thread.
+         *
+         * @return This builder.
+         * @since 2.2.0
+         */
+        Builder& useAutonomousReaderMonitoring();
+
+        /**
+         * Makes the readers report the card insertion and removal by themselves.
+         *
+         * <p>By default, Keyple core dedicates a thread per observed reader, blocked in the
+         * waiting methods of the reader. With this option, the readers behave as autonomous
+         * observable readers: the card presence changes of all the readers are detected by a single
+         * PC/SC monitoring thread and delivered to Keyple core by a small pool of threads shared by
+         * all the readers.
+         *
+         * @return This builder.
+         * @since 2.2.0
+         */
+        Builder& useAutonomousCardMonitoring();
+
+        /**
+         * Makes the readers identify the type of the inserted cards from an ATR database.
+         *
+         * <p>The database file is produced offline by the keyplepluginpcscatrdb tool (built with
+         * the KEYPLE_PCSC_TOOLS option) from a text file listing one entry per line:
+         *
+         * <pre>
+         * # Comment
+         * 3B8F8001804F0CA0000003060300 MIFARE Classic 1K
+         * 3B8F80/FFFFF0 Any contactless storage card
+         * </pre>
+         *
+         * <p>Each entry is an ATR prefix in hex, optionally followed by '/' and a mask of the same
+         * length, then the card type. An ATR matches an entry when it starts with the prefix, each
+         * byte being compared through the mask. When several entries match, the longest prefix
+         * wins, then the one with the most mask bits set, then the first one of the file.
+         *
+         * <p>The file is memory-mapped: no parsing takes place at startup, and the lookup
+         * performed when a card is connected only depends on the ATR length, not on the number of
+         * entries. The card type is then available from {@link PcscReader#getCardType()}.
+         *
+         * @param atrDatabasePath The path of the database file.
+         * @return This builder.
+         * @throw IllegalArgumentException If the path is empty or the file is not a valid ATR
+         *     database.
+         * @since 2.2.0
+         */
+        Builder& useAtrDatabase(const std::string& atrDatabasePath);
+
         /**
          * Returns an instance of PcscPluginFactory created from the fields set on this builder.
          *
@@ -154,6 +217,21 @@ public:
          */
         std::map<std::string, std::string> mProtocolRulesMap;
 
+        /**
+         *
+         */
+        bool mIsAutonomousReaderMonitoringEnabled;
+
+        /**
+         *
+         */
+        bool mIsAutonomousCardMonitoringEnabled;
+
+        /**
+         *
+         */
+        std::shared_ptr<cpp::AtrDatabase> mAtrDatabase;
+
         /**
          * (private) Constructs an empty Builder. The default value of all strings is null, the
          * default value of the map is an empty map.
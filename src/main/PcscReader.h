@@ -12,6 +12,11 @@
 
 #pragma once
 
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
 #include <ostream>
 #include <string>
 #include <vector>
@@ -148,6 +153,145 @@ public:
         LEAVE
     };
 
+    /**
+     * Command APDU of a batch transmitted with transmitApdus, with its expected status word.
+     *
+     * <p>The status word SW of the response is expected if (SW & statusWordMask) is equal to
+     * (expectedStatusWord & statusWordMask). The default mask (0) accepts any status word.
+     *
+     * @since 2.2.0
+     */
+    struct KEYPLEPLUGINPCSC_API BatchApdu {
+        /**
+         * The command APDU.
+         *
+         * @since 2.2.0
+         */
+        std::vector<uint8_t> command;
+
+        /**
+         * The expected status word.
+         *
+         * @since 2.2.0
+         */
+        uint16_t expectedStatusWord = 0x9000;
+
+        /**
+         * The bits of the status word to check.
+         *
+         * @since 2.2.0
+         */
+        uint16_t statusWordMask = 0x0000;
+    };
+
+    /**
+     * Responses of a batch transmitted with transmitApdus.
+     *
+     * <p>Can be reused from one batch to another to avoid reallocating the buffers.
+     *
+     * @since 2.2.0
+     */
+    struct KEYPLEPLUGINPCSC_API BatchResponse {
+        /**
+         * The response APDUs (data and status word), concatenated in the order of the commands.
+         *
+         * @since 2.2.0
+         */
+        std::vector<uint8_t> responses;
+
+        /**
+         * The end offset in responses of each response received, thus one element per command
+         * transmitted.
+         *
+         * @since 2.2.0
+         */
+        std::vector<size_t> responseEnds;
+
+        /**
+         * True if all the commands have been transmitted, false if the batch was interrupted by an
+         * unexpected status word (the one of the last response).
+         *
+         * @since 2.2.0
+         */
+        bool isComplete = false;
+    };
+
+    /**
+     * Completion callback of an asynchronous APDU transmission.
+     *
+     * <p>Receives the response APDU, or a not null error (CardIOException, ReaderIOException) if
+     * the transmission has failed. Invoked from the I/O thread of the reader, implementations
+     * must return quickly.
+     *
+     * @since 2.2.0
+     */
+    typedef std::function<void(const std::vector<uint8_t>& apduResponseData,
+                               std::exception_ptr error)> TransmitCallback;
+
+    /**
+     * Activity of the I/O thread of the reader, see transmitApduAsync.
+     *
+     * @since 2.2.0
+     */
+    struct KEYPLEPLUGINPCSC_API AsyncTransmitMetrics {
+        /**
+         * The number of commands queued or being transmitted.
+         *
+         * @since 2.2.0
+         */
+        size_t queueDepth = 0;
+
+        /**
+         * The number of commands processed, successfully or not.
+         *
+         * @since 2.2.0
+         */
+        uint64_t transmittedCount = 0;
+
+        /**
+         * The cumulated time spent by the processed commands in the queue (in microseconds).
+         *
+         * @since 2.2.0
+         */
+        uint64_t totalWaitTime = 0;
+
+        /**
+         * The longest time spent by a command in the queue (in microseconds).
+         *
+         * @since 2.2.0
+         */
+        uint64_t maxWaitTime = 0;
+    };
+
+    /**
+     * Decides whether a card inserted in the reader is processed, before any connection to it.
+     *
+     * @since 2.2.0
+     */
+    class KEYPLEPLUGINPCSC_API InsertedCardFilter {
+    public:
+        /**
+         *
+         */
+        virtual ~InsertedCardFilter() = default;
+
+        /**
+         * Invoked when a card is inserted, with the ATR reported by the PC/SC service along with
+         * the card presence.
+         *
+         * <p>Invoked from the card monitoring thread of the plugin, implementations must return
+         * quickly. The protocols matched by the ATR are already available from {@link
+         * #isInsertedCardProtocol(String)}.
+         *
+         * @param atr The ATR of the inserted card (may be empty if the PC/SC service does not
+         *     provide it).
+         * @return false to ignore the card: the insertion is not reported to Keyple core and the
+         *     card is considered absent until it is removed.
+         * @since 2.2.0
+         */
+        virtual bool accept(const std::vector<uint8_t>& atr) = 0;
+    };
+
     /**
      *
      */
@@ -156,7 +300,15 @@ public:
     /**
      * Changes the PC/SC sharing mode (default value {@link SharingMode#EXCLUSIVE}).
      *
-     * <p>This mode will be used when a new {@link Card} is created.
+     * <p>This mode will be used when a new {@link Card} is created. In
+     * {@link SharingMode#EXCLUSIVE} mode the card is connected with SCARD_SHARE_EXCLUSIVE, other
+     * applications cannot connect to it until the physical channel is closed. If another
+     * application is already connected, the connection is shared and the exclusivity relies on a
+     * transaction held for the whole channel session. Use {@link SharingMode#SHARED} to let other
+     * applications access the card.
+     *
+     * <p>In {@link SharingMode#SHARED} mode, only the APDUs transmitted as a batch are protected
+     * from the exchanges of the other applications by a transaction.
      *
      * <p>If a card is already inserted, changes immediately the mode in the current {@link Card}
      * object.
@@ -224,6 +376,40 @@ public:
      */
     virtual PcscReader& setDisconnectionMode(const DisconnectionMode disconnectionMode) = 0;
 
+    /**
+     * Keeps the connection to the card alive when the physical channel is closed (default value
+     * false).
+     *
+     * <p>Reopening the channel then only checks the card status instead of connecting again, which
+     * makes the channel opening almost free for the cards that stay inserted, such as SAMs.
+     *
+     * <p>When the channel is closed, the card is reset with {@link DisconnectionMode#RESET} and
+     * left as is with {@link DisconnectionMode#LEAVE}. The card is available to the other
+     * applications between two channels, except when connected in {@link SharingMode#EXCLUSIVE}
+     * mode while no other application was connected.
+     *
+     * @param connectionReuse true to keep the connection alive between the channels.
+     * @return This instance.
+     * @since 2.2.0
+     */
+    virtual PcscReader& setConnectionReuse(const bool connectionReuse) = 0;
+
+    /**
+     * Makes the closing of the physical channel asynchronous (default value false).
+     *
+     * <p>The disconnection (or the card reset, see {@link DisconnectionMode#RESET}) is then
+     * performed by a background thread of the plugin and the channel closing returns immediately,
+     * so that the processing of the next card can start while the previous one is being released.
+     *
+     * <p>The reader is not ready until the teardown has completed: the next channel opening and
+     * the card presence checks requiring the card wait for it.
+     *
+     * @param asynchronousChannelClosing true to close the physical channel asynchronously.
+     * @return This instance.
+     * @since 2.2.0
+     */
+    virtual PcscReader& setAsynchronousChannelClosing(const bool asynchronousChannelClosing) = 0;
+
     /**
      * Transmits a control command to the terminal device.
      *
@@ -254,6 +440,113 @@ public:
      */
     virtual int getIoctlCcidEscapeCommandId() const = 0;
 
+    /**
+     * Transmits a batch of APDUs to the card inserted, back-to-back within a single PC/SC
+     * transaction.
+     *
+     * <p>The transmission stops at the first response whose status word is not the expected one.
+     *
+     * <p>This is intended for the scripted exchanges such as card personalization or SAM warm-up:
+     * the card is not arbitrated by the PC/SC service between the commands, and the responses are
+     * collected in a single buffer.
+     *
+     * @param apdus The commands to transmit.
+     * @param batchResponse The object receiving the responses (its previous content is lost).
+     * @throw CardIOException If the communication with the card has failed.
+     * @throw ReaderIOException If the communication with the reader has failed.
+     * @since 2.2.0
+     */
+    virtual void transmitApdus(const std::vector<BatchApdu>& apdus,
+                               BatchResponse& batchResponse) = 0;
+
+    /**
+     * Gets the type of the card connected by the last physical channel opening, as identified by
+     * the ATR database of the plugin.
+     *
+     * @return An empty string if no ATR database is used or if the ATR is not referenced.
+     * @see PcscPluginFactoryBuilder.Builder#useAtrDatabase(String)
+     * @since 2.2.0
+     */
+    virtual const std::string getCardType() const = 0;
+
+    /**
+     * Sets the filter deciding whether an inserted card is processed (default value null, all the
+     * cards are processed).
+     *
+     * <p>The filter is applied to the card presence events of the plugin monitor, thus the
+     * ignored cards cost no connection and disconnection. It only applies once the card presence
+     * is being monitored, i.e. while the reader is observed.
+     *
+     * @param insertedCardFilter The filter, null to process all the cards.
+     * @return This instance.
+     * @since 2.2.0
+     */
+    virtual PcscReader& setInsertedCardFilter(
+        std::shared_ptr<InsertedCardFilter> insertedCardFilter) = 0;
+
+    /**
+     * Gets the ATR of the last inserted card, as reported by the PC/SC service with the card
+     * presence, without connecting to the card.
+     *
+     * @return An empty vector if no insertion has been detected while the reader was observed.
+     * @since 2.2.0
+     */
+    virtual const std::vector<uint8_t> getInsertedCardAtr() const = 0;
+
+    /**
+     * Tells if the ATR of the last inserted card (see {@link #getInsertedCardAtr()}) matches the
+     * rule of the provided protocol.
+     *
+     * <p>Allows to choose the protocol to request, or to ignore the card, before connecting.
+     *
+     * @param readerProtocol The reader protocol.
+     * @return false if the protocol is unknown or if no insertion has been detected.
+     * @since 2.2.0
+     */
+    virtual bool isInsertedCardProtocol(const std::string& readerProtocol) const = 0;
+
+    /**
+     * Transmits an APDU to the card without blocking the calling thread.
+     *
+     * <p>The command is queued to the I/O thread dedicated to the reader, started on the first
+     * asynchronous transmission. The commands are transmitted in the order of submission, so that
+     * a single application thread can drive several readers concurrently.
+     *
+     * <p>The physical channel must be open when the command is transmitted. The synchronous
+     * operations on the reader may be called meanwhile: they are serialized with the queued
+     * commands, but their order relative to these commands is not defined.
+     *
+     * @param apduCommandData The command.
+     * @return The future response, holding a CardIOException or a ReaderIOException if the
+     *     communication with the card or the reader has failed, or a ReaderIOException if the
+     *     reader is released before the command is transmitted.
+     * @since 2.2.0
+     */
+    virtual std::future<std::vector<uint8_t>> transmitApduAsync(
+        const std::vector<uint8_t>& apduCommandData) = 0;
+
+    /**
+     * Same as transmitApduAsync(const std::vector<uint8_t>&), the response being provided to a
+     * callback.
+     *
+     * @param apduCommandData The command.
+     * @param callback The callback invoked once the command is completed, with a
+     *     ReaderIOException if the reader is released before (the callback is then invoked by the
+     *     thread releasing the reader).
+     * @throw IllegalArgumentException If callback is null.
+     * @since 2.2.0
+     */
+    virtual void transmitApduAsync(const std::vector<uint8_t>& apduCommandData,
+                                   const TransmitCallback& callback) = 0;
+
+    /**
+     * Gets the activity of the I/O thread of the reader.
+     *
+     * @return All the values are null if no asynchronous transmission has been requested.
+     * @since 2.2.0
+     */
+    virtual const AsyncTransmitMetrics getAsyncTransmitMetrics() const = 0;
+
     /**
      *
      */
@@ -12,13 +12,13 @@
 
 #include "PcscReaderAdapter.h"
 
-/* Keyple Plugin Pcsc */
-#include "CardException.h"
-
 /* Keyple Core Plugin */
 #include "ReaderIOException.h"
 #include "TaskCanceledException.h"
 
+/* Keyple Plugin Pcsc */
+#include "CardException.h"
+
 namespace keyple {
 namespace plugin {
 namespace pcsc {
@@ -27,11 +27,11 @@ using namespace keyple::core::plugin;
 using namespace keyple::plugin::pcsc::cpp::exception;
 
 const long PcscReaderAdapter::INSERTION_LATENCY = 500;
+const long PcscReaderAdapter::REMOVAL_LATENCY = 500;
 
 PcscReaderAdapter::PcscReaderAdapter(std::shared_ptr<CardTerminal> terminal,
                                      std::shared_ptr<AbstractPcscPluginAdapter> pluginAdapter)
-: AbstractPcscReaderAdapter(terminal, pluginAdapter),
-  mLoopWaitCard(false) {}
+: AbstractPcscReaderAdapter(terminal, pluginAdapter) {}
 
 void PcscReaderAdapter::waitForCardInsertion()
 {
@@ -41,20 +41,16 @@ void PcscReaderAdapter::waitForCardInsertion()
                    INSERTION_LATENCY);
 
 
-    /* Activate loop */
-    mLoopWaitCard = true;
-
+    /* Loops until the card is inserted or the wait is cancelled, even before it started */
     try {
-        while (mLoopWaitCard) {
-            if (getTerminal()->waitForCardPresent(INSERTION_LATENCY)) {
+        CardPresenceTracker::WaitResult result;
+        while ((result = waitForCardPresence(true, INSERTION_LATENCY)) !=
+                   CardPresenceTracker::WaitResult::CANCELLED) {
+            if (result == CardPresenceTracker::WaitResult::REACHED) {
                 /* Card inserted */
                 mLogger->trace("%: card inserted\n", getName());
                 return;
             }
-
-            // if (Thread.interrupted()) {
-            //     break;
-            // }
         }
     } catch (const CardException& e) {
         /* Here, it is a communication failure with the reader */
@@ -71,7 +67,44 @@ void PcscReaderAdapter::stopWaitForCardInsertion()
 {
     mLogger->trace("%: stop waiting for card insertion requested\n", getName());
 
-    mLoopWaitCard = false;
+    cancelWaitForCardPresence(true);
+}
+
+void PcscReaderAdapter::waitForCardRemoval()
+{
+    mLogger->trace("%: start waiting for the removal of the card in a loop with a latency of % " \
+                   "ms\n",
+                   getName(),
+                   REMOVAL_LATENCY);
+
+
+    /* Loops until the card is removed or the wait is cancelled, even before it started */
+    try {
+        CardPresenceTracker::WaitResult result;
+        while ((result = waitForCardPresence(false, REMOVAL_LATENCY)) !=
+                   CardPresenceTracker::WaitResult::CANCELLED) {
+            if (result == CardPresenceTracker::WaitResult::REACHED) {
+                /* Card removed */
+                mLogger->trace("%: card removed\n", getName());
+                return;
+            }
+        }
+    } catch (const CardException& e) {
+        /* Here, it is a communication failure with the reader */
+        throw ReaderIOException(getName() +
+                                ": an error occurred while waiting for the card removal.",
+                                std::make_shared<CardException>(e));
+    }
+
+    throw TaskCanceledException(getName() +
+                                ": the wait for the card removal task has been cancelled.");
+}
+
+void PcscReaderAdapter::stopWaitForCardRemoval()
+{
+    mLogger->trace("%: stop waiting for the card removal requested\n", getName());
+
+    cancelWaitForCardPresence(false);
 }
 
 }
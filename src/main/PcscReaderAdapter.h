@@ -12,7 +12,6 @@
 
 #pragma once
 
-#include <atomic>
 #include <memory>
 #include <typeinfo>
 
@@ -21,6 +20,7 @@
 
 /* Keyple Core Plugin */
 #include "WaitForCardInsertionBlockingSpi.h"
+#include "WaitForCardRemovalBlockingSpi.h"
 
 /* Keyple Core Util */
 #include "LoggerFactory.h"
@@ -30,16 +30,22 @@ namespace plugin {
 namespace pcsc {
 
 using namespace keyple::core::plugin::spi::reader::observable::state::insertion;
+using namespace keyple::core::plugin::spi::reader::observable::state::removal;
 using namespace keyple::core::util::cpp;
 
 /**
  * (package-private)<br>
  * Implementation of AbstractPcscReaderAdapter suitable for platforms other than MacOS.
  *
+ * <p>Keyple core waits for the card insertion and removal by calling the blocking methods of this
+ * reader from a dedicated thread.
+ *
  * @since 2.0.0
  */
 class PcscReaderAdapter final
-: public AbstractPcscReaderAdapter, public WaitForCardInsertionBlockingSpi {
+: public AbstractPcscReaderAdapter,
+  public WaitForCardInsertionBlockingSpi,
+  public WaitForCardRemovalBlockingSpi {
 public:
     /**
      * (package-private)<br>
@@ -62,6 +68,20 @@ public:
      */
     void stopWaitForCardInsertion() override;
 
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.0.0
+     */
+    void waitForCardRemoval() override;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.0.0
+     */
+    void stopWaitForCardRemoval() override;
+
 private:
     /**
      * 
@@ -71,14 +91,18 @@ private:
     /*
      * The latency delay value (in ms) determines the maximum time during which the
      * waitForCardPresent blocking functions will execute.
-     * This will correspond to the capacity to react to the interrupt signal of the thread.
+     * A stop request interrupts the wait immediately, or as soon as it starts if it was issued
+     * before.
      */
     static const long INSERTION_LATENCY;
 
     /**
-     * 
+     * The latency delay value (in ms) determines the maximum time during which the
+     * waitForCardAbsent blocking functions will execute.
+     * A stop request interrupts the wait immediately, or as soon as it starts if it was issued
+     * before.
      */
-    std::atomic<bool> mLoopWaitCard;
+    static const long REMOVAL_LATENCY;
 };
 
 }
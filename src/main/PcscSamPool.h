@@ -0,0 +1,184 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/* Keyple Plugin Pcsc */
+#include "KeyplePluginPcscExport.h"
+#include "PcscReader.h"
+
+namespace keyple {
+namespace plugin {
+namespace pcsc {
+
+/**
+ * Pool of SAMs inserted in PC/SC readers, created by PcscPlugin::createSamPool.
+ *
+ * <p>The physical channel of each SAM is opened when the pool is created and stays open until the
+ * pool is released, so that leasing a SAM costs no connection. A SAM is leased to one transaction
+ * at a time and returned to the pool when the lease is released.
+ *
+ * <p>A SAM whose channel could not be opened, or whose transmission has failed, is considered
+ * unhealthy: it is no longer leased while healthy SAMs are available, and its channel is opened
+ * again when it is needed, at most once per recovery period.
+ *
+ * @since 2.2.0
+ */
+class KEYPLEPLUGINPCSC_API PcscSamPool {
+public:
+    /**
+     * Selection of the SAM to lease among the available ones.
+     *
+     * @since 2.2.0
+     */
+    enum class SelectionPolicy {
+        /**
+         * The SAM with the lowest cumulated lease duration.
+         *
+         * @since 2.2.0
+         */
+        LEAST_LOADED,
+
+        /**
+         * The SAMs in turn.
+         *
+         * @since 2.2.0
+         */
+        ROUND_ROBIN
+    };
+
+    /**
+     * Exclusive use of a SAM of the pool, the SAM is returned to the pool when the lease is
+     * released.
+     *
+     * @since 2.2.0
+     */
+    class KEYPLEPLUGINPCSC_API Lease {
+    public:
+        /**
+         * Returns the SAM to the pool.
+         */
+        virtual ~Lease() = default;
+
+        /**
+         * Gets the reader of the SAM, whose physical channel is open.
+         *
+         * <p>The failures of the exchanges made directly through the reader are not seen by the
+         * pool: the caller must then call {@link #setUnhealthy()}, or else transmit the APDUs with
+         * {@link #transmitApdu(const std::vector<uint8_t>&)}.
+         *
+         * @return A not null reference, valid until the lease is released.
+         * @since 2.2.0
+         */
+        virtual PcscReader& getReader() = 0;
+
+        /**
+         * @return The name of the reader of the SAM.
+         * @since 2.2.0
+         */
+        virtual const std::string& getReaderName() const = 0;
+
+        /**
+         * Transmits an APDU to the SAM.
+         *
+         * <p>The SAM is marked unhealthy if the transmission fails.
+         *
+         * @param apduCommandData The command.
+         * @return The response (data and status word).
+         * @throw CardIOException If the communication with the SAM has failed.
+         * @throw ReaderIOException If the communication with the reader has failed.
+         * @since 2.2.0
+         */
+        virtual const std::vector<uint8_t> transmitApdu(
+            const std::vector<uint8_t>& apduCommandData) = 0;
+
+        /**
+         * Marks the SAM unhealthy, e.g. when its responses are not the expected ones.
+         *
+         * @since 2.2.0
+         */
+        virtual void setUnhealthy() = 0;
+    };
+
+    /**
+     * State and activity of a SAM of the pool.
+     *
+     * @since 2.2.0
+     */
+    struct KEYPLEPLUGINPCSC_API SamStatistics {
+        /**
+         * The reader name.
+         *
+         * @since 2.2.0
+         */
+        std::string readerName;
+
+        /**
+         * false if the SAM is skipped until it recovers.
+         *
+         * @since 2.2.0
+         */
+        bool isHealthy = false;
+
+        /**
+         * true if the SAM is currently leased.
+         *
+         * @since 2.2.0
+         */
+        bool isLeased = false;
+
+        /**
+         * The number of leases of the SAM.
+         *
+         * @since 2.2.0
+         */
+        uint64_t leaseCount = 0;
+
+        /**
+         * The cumulated duration of the leases of the SAM (in microseconds).
+         *
+         * @since 2.2.0
+         */
+        uint64_t busyTime = 0;
+    };
+
+    /**
+     * Closes the physical channels of the SAMs.
+     */
+    virtual ~PcscSamPool() = default;
+
+    /**
+     * Leases a SAM, waiting for one to be returned if they are all leased.
+     *
+     * @param timeout The maximum time to wait (in milliseconds).
+     * @return The lease, null if no SAM was available before the timeout.
+     * @since 2.2.0
+     */
+    virtual std::unique_ptr<Lease> lease(const long timeout) = 0;
+
+    /**
+     * Gets the state and the activity of each SAM.
+     *
+     * @return The statistics, in the order of the readers provided when creating the pool.
+     * @since 2.2.0
+     */
+    virtual const std::vector<SamStatistics> getStatistics() const = 0;
+};
+
+}
+}
+}
@@ -0,0 +1,248 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include "SamPoolAdapter.h"
+
+/* Keyple Core Util */
+#include "Exception.h"
+
+namespace keyple {
+namespace plugin {
+namespace pcsc {
+
+using namespace keyple::core::util::cpp::exception;
+
+const long SamPoolAdapter::RECOVERY_PERIOD_MS = 5000;
+
+SamPoolAdapter::SamPoolAdapter(
+  const std::vector<std::shared_ptr<AbstractPcscReaderAdapter>>& readers,
+  const SelectionPolicy selectionPolicy)
+: mSelectionPolicy(selectionPolicy),
+  mLastLeasedIndex(readers.size() - 1)
+{
+    const auto now = std::chrono::steady_clock::now();
+
+    for (const auto& reader : readers) {
+        /* A SAM failing to open is recovered when needed, not before */
+        const bool isHealthy = openChannel(*reader, false);
+        if (!isHealthy) {
+            mLogger->warn("%: SAM unavailable, excluded from the pool until it recovers\n",
+                          reader->getName());
+        }
+
+        mSams.push_back({reader, isHealthy, false, now, now, 0, 0});
+    }
+}
+
+SamPoolAdapter::~SamPoolAdapter()
+{
+    /* The leases keep the pool alive, no SAM is leased anymore */
+    for (const Sam& sam : mSams) {
+        try {
+            sam.reader->closePhysicalChannel();
+        } catch (const Exception& e) {
+            mLogger->warn("%: unable to close the SAM channel: %\n",
+                          sam.reader->getName(),
+                          e.getMessage());
+        }
+    }
+}
+
+std::unique_ptr<PcscSamPool::Lease> SamPoolAdapter::lease(const long timeout)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    while (true) {
+        const auto now = std::chrono::steady_clock::now();
+        const size_t index = select(now);
+
+        if (index < mSams.size()) {
+            Sam& sam = mSams[index];
+            sam.isLeased = true;
+
+            if (!sam.isHealthy) {
+                /* The SAM is reserved, its channel is reopened without holding the lock */
+                lock.unlock();
+                const bool isRecovered = openChannel(*sam.reader, true);
+                lock.lock();
+
+                if (!isRecovered) {
+                    sam.isLeased = false;
+                    sam.nextRecoveryTime = std::chrono::steady_clock::now() +
+                                           std::chrono::milliseconds(RECOVERY_PERIOD_MS);
+                    continue;
+                }
+
+                mLogger->info("%: SAM recovered\n", sam.reader->getName());
+                sam.isHealthy = true;
+            }
+
+            sam.leaseStartTime = std::chrono::steady_clock::now();
+            sam.leaseCount++;
+            mLastLeasedIndex = index;
+
+            return std::unique_ptr<Lease>(new LeaseAdapter(shared_from_this(), index));
+        }
+
+        if (now >= deadline) {
+            return nullptr;
+        }
+
+        /* Woken up by a returned SAM, or when an unhealthy SAM is due for recovery */
+        auto wakeUpTime = deadline;
+        for (const Sam& sam : mSams) {
+            if (!sam.isHealthy && !sam.isLeased && sam.nextRecoveryTime < wakeUpTime) {
+                wakeUpTime = sam.nextRecoveryTime;
+            }
+        }
+
+        mCondition.wait_until(lock, wakeUpTime);
+    }
+}
+
+const std::vector<PcscSamPool::SamStatistics> SamPoolAdapter::getStatistics() const
+{
+    std::vector<SamStatistics> statistics;
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    for (const Sam& sam : mSams) {
+        SamStatistics samStatistics;
+        samStatistics.readerName = sam.reader->getName();
+        samStatistics.isHealthy = sam.isHealthy;
+        samStatistics.isLeased = sam.isLeased;
+        samStatistics.leaseCount = sam.leaseCount;
+        samStatistics.busyTime = sam.busyTime;
+        statistics.push_back(samStatistics);
+    }
+
+    return statistics;
+}
+
+size_t SamPoolAdapter::select(const std::chrono::steady_clock::time_point now) const
+{
+    const size_t count = mSams.size();
+    size_t selected = count;
+
+    for (size_t i = 0; i < count; i++) {
+        /* In turn from the SAM following the last one leased */
+        const size_t index = (mLastLeasedIndex + 1 + i) % count;
+        const Sam& sam = mSams[index];
+        if (sam.isLeased || !sam.isHealthy) {
+            continue;
+        }
+
+        if (mSelectionPolicy == SelectionPolicy::ROUND_ROBIN) {
+            return index;
+        }
+
+        if (selected == count || sam.busyTime < mSams[selected].busyTime) {
+            selected = index;
+        }
+    }
+
+    if (selected != count) {
+        return selected;
+    }
+
+    /* No healthy SAM available, an unhealthy one is given a chance to recover */
+    for (size_t i = 0; i < count; i++) {
+        const Sam& sam = mSams[i];
+        if (!sam.isLeased && !sam.isHealthy && sam.nextRecoveryTime <= now) {
+            return i;
+        }
+    }
+
+    return count;
+}
+
+bool SamPoolAdapter::openChannel(AbstractPcscReaderAdapter& reader, const bool isReopened) const
+{
+    try {
+        if (isReopened) {
+            reader.closePhysicalChannel();
+        }
+
+        reader.openPhysicalChannel();
+
+        return true;
+
+    } catch (const Exception& e) {
+        mLogger->warn("%: unable to open the SAM channel: %\n", reader.getName(), e.getMessage());
+
+        return false;
+    }
+}
+
+void SamPoolAdapter::giveBack(const size_t index, const bool isHealthy)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    Sam& sam = mSams[index];
+    sam.isLeased = false;
+    sam.busyTime += std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - sam.leaseStartTime)
+                        .count();
+
+    if (!isHealthy) {
+        mLogger->warn("%: SAM unhealthy, excluded from the pool until it recovers\n",
+                      sam.reader->getName());
+        sam.isHealthy = false;
+        sam.nextRecoveryTime = std::chrono::steady_clock::now();
+    }
+
+    mCondition.notify_all();
+}
+
+/* LEASE ADAPTER -------------------------------------------------------------------------------- */
+
+SamPoolAdapter::LeaseAdapter::LeaseAdapter(std::shared_ptr<SamPoolAdapter> pool, const size_t index)
+: mPool(pool), mIndex(index), mReader(pool->mSams[index].reader), mIsHealthy(true) {}
+
+SamPoolAdapter::LeaseAdapter::~LeaseAdapter()
+{
+    mPool->giveBack(mIndex, mIsHealthy);
+}
+
+PcscReader& SamPoolAdapter::LeaseAdapter::getReader()
+{
+    return *mReader;
+}
+
+const std::string& SamPoolAdapter::LeaseAdapter::getReaderName() const
+{
+    return mReader->getName();
+}
+
+const std::vector<uint8_t> SamPoolAdapter::LeaseAdapter::transmitApdu(
+    const std::vector<uint8_t>& apduCommandData)
+{
+    try {
+        return mReader->transmitApdu(apduCommandData);
+
+    } catch (const Exception& e) {
+        (void)e;
+        mIsHealthy = false;
+        throw;
+    }
+}
+
+void SamPoolAdapter::LeaseAdapter::setUnhealthy()
+{
+    mIsHealthy = false;
+}
+
+}
+}
+}
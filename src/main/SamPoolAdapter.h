@@ -0,0 +1,208 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <typeinfo>
+#include <vector>
+
+/* Keyple Plugin Pcsc */
+#include "AbstractPcscReaderAdapter.h"
+#include "PcscSamPool.h"
+
+/* Keyple Core Util */
+#include "LoggerFactory.h"
+
+namespace keyple {
+namespace plugin {
+namespace pcsc {
+
+using namespace keyple::core::util::cpp;
+
+/**
+ * (package-private)<br>
+ * Implementation of PcscSamPool.
+ *
+ * @since 2.2.0
+ */
+class SamPoolAdapter final
+: public PcscSamPool,
+  public std::enable_shared_from_this<SamPoolAdapter> {
+public:
+    /**
+     * (package-private)<br>
+     * Creates the pool and opens the physical channel of each SAM.
+     *
+     * @param readers The readers of the SAMs, each one appearing once.
+     * @param selectionPolicy The selection of the SAM to lease.
+     * @since 2.2.0
+     */
+    SamPoolAdapter(const std::vector<std::shared_ptr<AbstractPcscReaderAdapter>>& readers,
+                   const SelectionPolicy selectionPolicy);
+
+    /**
+     * Closes the physical channels of the SAMs.
+     */
+    ~SamPoolAdapter();
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.0
+     */
+    std::unique_ptr<Lease> lease(const long timeout) override;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.0
+     */
+    const std::vector<SamStatistics> getStatistics() const override;
+
+private:
+    /**
+     * SAM of the pool, guarded by mMutex.
+     */
+    struct Sam {
+        std::shared_ptr<AbstractPcscReaderAdapter> reader;
+        bool isHealthy;
+        bool isLeased;
+        std::chrono::steady_clock::time_point nextRecoveryTime;
+        std::chrono::steady_clock::time_point leaseStartTime;
+        uint64_t leaseCount;
+        uint64_t busyTime;
+    };
+
+    /**
+     * Lease of a SAM, keeping the pool alive.
+     */
+    class LeaseAdapter final : public Lease {
+    public:
+        /**
+         *
+         */
+        LeaseAdapter(std::shared_ptr<SamPoolAdapter> pool, const size_t index);
+
+        /**
+         * Returns the SAM to the pool.
+         */
+        ~LeaseAdapter();
+
+        /**
+         * {@inheritDoc}
+         */
+        PcscReader& getReader() override;
+
+        /**
+         * {@inheritDoc}
+         */
+        const std::string& getReaderName() const override;
+
+        /**
+         * {@inheritDoc}
+         */
+        const std::vector<uint8_t> transmitApdu(const std::vector<uint8_t>& apduCommandData)
+            override;
+
+        /**
+         * {@inheritDoc}
+         */
+        void setUnhealthy() override;
+
+    private:
+        /**
+         *
+         */
+        const std::shared_ptr<SamPoolAdapter> mPool;
+
+        /**
+         *
+         */
+        const size_t mIndex;
+
+        /**
+         *
+         */
+        const std::shared_ptr<AbstractPcscReaderAdapter> mReader;
+
+        /**
+         *
+         */
+        bool mIsHealthy;
+    };
+
+    /**
+     * Minimum time between two attempts to open again the channel of an unhealthy SAM.
+     */
+    static const long RECOVERY_PERIOD_MS;
+
+    /**
+     *
+     */
+    const std::unique_ptr<Logger> mLogger = LoggerFactory::getLogger(typeid(SamPoolAdapter));
+
+    /**
+     *
+     */
+    const SelectionPolicy mSelectionPolicy;
+
+    /**
+     *
+     */
+    mutable std::mutex mMutex;
+
+    /**
+     * Notified when a SAM is returned.
+     */
+    std::condition_variable mCondition;
+
+    /**
+     *
+     */
+    std::vector<Sam> mSams;
+
+    /**
+     * Index of the last SAM leased, for the round-robin selection.
+     */
+    size_t mLastLeasedIndex;
+
+    /**
+     * (private)<br>
+     * Selects a healthy SAM not leased according to the selection policy or, failing that, an
+     * unhealthy SAM due for recovery.
+     *
+     * @return The index of the SAM, mSams.size() if none is available.
+     */
+    size_t select(const std::chrono::steady_clock::time_point now) const;
+
+    /**
+     * (private)<br>
+     * Closes and opens again the physical channel of a SAM.
+     *
+     * @return false if the channel could not be opened.
+     */
+    bool openChannel(AbstractPcscReaderAdapter& reader, const bool isReopened) const;
+
+    /**
+     * (private)<br>
+     * Returns a leased SAM to the pool.
+     */
+    void giveBack(const size_t index, const bool isHealthy);
+};
+
+}
+}
+}
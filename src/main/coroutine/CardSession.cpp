@@ -0,0 +1,142 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include "CardSession.h"
+
+/* Keyple Core Util */
+#include "IllegalArgumentException.h"
+#include "IllegalStateException.h"
+
+namespace keyple {
+namespace plugin {
+namespace pcsc {
+namespace coroutine {
+
+using namespace keyple::core::util::cpp::exception;
+
+PresenceAwaitable::PresenceAwaitable(CardSessionScheduler& scheduler,
+                                     std::shared_ptr<CardTerminal> terminal,
+                                     const bool present,
+                                     const long timeout)
+: mScheduler(scheduler),
+  mTerminal(terminal),
+  mTimeout(timeout),
+  mWait(std::make_shared<CardSessionScheduler::PresenceWait>())
+{
+    mWait->present = present;
+}
+
+bool PresenceAwaitable::await_ready() const noexcept
+{
+    return false;
+}
+
+void PresenceAwaitable::await_suspend(std::coroutine_handle<> handle)
+{
+    mWait->handle = handle;
+
+    if (mTimeout != 0) {
+        mScheduler.waitForCardPresence(mTerminal->getName(), mWait, mTimeout);
+        return;
+    }
+
+    /* Only the current state is checked, without waiting for the monitor */
+    mScheduler.execute([this, handle]() {
+        try {
+            mWait->isReached = mTerminal->isCardPresent(false) == mWait->present;
+        } catch (...) {
+            mError = std::current_exception();
+        }
+
+        handle.resume();
+    });
+}
+
+bool PresenceAwaitable::await_resume()
+{
+    if (mError) {
+        std::rethrow_exception(mError);
+    }
+
+    if (mWait->isCancelled) {
+        throw IllegalStateException("The card session scheduler has been stopped");
+    }
+
+    return mWait->isReached;
+}
+
+CardSession::CardSession(std::shared_ptr<CardTerminal> terminal, CardSessionScheduler& scheduler)
+: mTerminal(terminal), mScheduler(scheduler)
+{
+    if (!terminal) {
+        throw IllegalArgumentException("Terminal should not be null");
+    }
+}
+
+std::shared_ptr<CardTerminal> CardSession::getTerminal() const
+{
+    return mTerminal;
+}
+
+IoAwaitable<void> CardSession::openAndConnect(const CardTerminal::ConnectionProtocol protocol,
+                                              const bool exclusive)
+{
+    const std::shared_ptr<CardTerminal> terminal = mTerminal;
+
+    return IoAwaitable<void>(mScheduler, [terminal, protocol, exclusive]() {
+        terminal->openAndConnect(protocol, exclusive);
+    });
+}
+
+IoAwaitable<std::vector<uint8_t>> CardSession::transmitApdu(std::vector<uint8_t> apdu)
+{
+    const std::shared_ptr<CardTerminal> terminal = mTerminal;
+
+    return IoAwaitable<std::vector<uint8_t>>(mScheduler, [terminal, apdu]() {
+        return terminal->transmitApdu(apdu);
+    });
+}
+
+IoAwaitable<std::vector<uint8_t>> CardSession::transmitControlCommand(const int commandId,
+                                                                      std::vector<uint8_t> command)
+{
+    const std::shared_ptr<CardTerminal> terminal = mTerminal;
+
+    return IoAwaitable<std::vector<uint8_t>>(mScheduler, [terminal, commandId, command]() {
+        return terminal->transmitControlCommand(commandId, command);
+    });
+}
+
+IoAwaitable<void> CardSession::closeAndDisconnect(const DisconnectionMode mode,
+                                                  const bool keepConnection)
+{
+    const std::shared_ptr<CardTerminal> terminal = mTerminal;
+
+    return IoAwaitable<void>(mScheduler, [terminal, mode, keepConnection]() {
+        terminal->closeAndDisconnect(mode, keepConnection);
+    });
+}
+
+PresenceAwaitable CardSession::waitForCardPresent(const long timeout)
+{
+    return PresenceAwaitable(mScheduler, mTerminal, true, timeout);
+}
+
+PresenceAwaitable CardSession::waitForCardAbsent(const long timeout)
+{
+    return PresenceAwaitable(mScheduler, mTerminal, false, timeout);
+}
+
+}
+}
+}
+}
@@ -0,0 +1,245 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+/* Keyple Plugin Pcsc */
+#include "CardSessionScheduler.h"
+#include "CardTerminal.h"
+
+namespace keyple {
+namespace plugin {
+namespace pcsc {
+namespace coroutine {
+
+using namespace keyple::plugin::pcsc::cpp;
+
+/**
+ * Awaitable executing a blocking card operation on an I/O thread of a {@link
+ * CardSessionScheduler}.
+ *
+ * <p>The awaiting coroutine is resumed on the I/O thread with the result of the operation, or the
+ * exception it has thrown.
+ */
+template <typename T>
+class IoAwaitable final {
+public:
+    /**
+     *
+     */
+    IoAwaitable(CardSessionScheduler& scheduler, std::function<T()> operation)
+    : mScheduler(scheduler), mOperation(std::move(operation)) {}
+
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        /* This instance must not be used once the task is queued, it may already be resumed */
+        mScheduler.execute([this, handle]() {
+            try {
+                if constexpr (std::is_void_v<T>) {
+                    mOperation();
+                } else {
+                    mResult.emplace(mOperation());
+                }
+            } catch (...) {
+                mError = std::current_exception();
+            }
+
+            handle.resume();
+        });
+    }
+
+    T await_resume()
+    {
+        if (mError) {
+            std::rethrow_exception(mError);
+        }
+
+        if constexpr (!std::is_void_v<T>) {
+            return std::move(*mResult);
+        }
+    }
+
+private:
+    /**
+     *
+     */
+    CardSessionScheduler& mScheduler;
+
+    /**
+     *
+     */
+    std::function<T()> mOperation;
+
+    /**
+     *
+     */
+    std::optional<std::conditional_t<std::is_void_v<T>, bool, T>> mResult;
+
+    /**
+     *
+     */
+    std::exception_ptr mError;
+};
+
+/**
+ * Awaitable waiting for a card presence, without blocking any thread.
+ *
+ * <p>Resumes the awaiting coroutine with true if the expected presence is reached, false if the
+ * timeout expired, or with an IllegalStateException if the scheduler is being destroyed.
+ */
+class PresenceAwaitable final {
+public:
+    /**
+     *
+     */
+    PresenceAwaitable(CardSessionScheduler& scheduler,
+                      std::shared_ptr<CardTerminal> terminal,
+                      const bool present,
+                      const long timeout);
+
+    bool await_ready() const noexcept;
+
+    void await_suspend(std::coroutine_handle<> handle);
+
+    bool await_resume();
+
+private:
+    /**
+     *
+     */
+    CardSessionScheduler& mScheduler;
+
+    /**
+     *
+     */
+    const std::shared_ptr<CardTerminal> mTerminal;
+
+    /**
+     *
+     */
+    const long mTimeout;
+
+    /**
+     *
+     */
+    const std::shared_ptr<CardSessionScheduler::PresenceWait> mWait;
+
+    /**
+     * Error of the immediate presence check (null timeout).
+     */
+    std::exception_ptr mError;
+};
+
+/**
+ * Awaitable card operations of a terminal, for the card session coroutines (see {@link Task}).
+ *
+ * <p>Each operation is the asynchronous counterpart of the {@link CardTerminal} method of the same
+ * name and throws the same exceptions when awaited. The operations of a session must be awaited
+ * one after the other, and a terminal must be used by a single session at a time.
+ *
+ * <p>Example:
+ *
+ * <pre>
+ * Task<std::vector<uint8_t>> readRecord(CardSession& session)
+ * {
+ *     if (!co_await session.waitForCardPresent(-1)) {
+ *         co_return std::vector<uint8_t>();
+ *     }
+ *
+ *     co_await session.openAndConnect(CardTerminal::ConnectionProtocol::ANY, true);
+ *     std::vector<uint8_t> record = co_await session.transmitApdu({0x00, 0xB2, 0x01, 0x0C, 0x00});
+ *     co_await session.closeAndDisconnect(DisconnectionMode::LEAVE, false);
+ *
+ *     co_return record;
+ * }
+ * </pre>
+ */
+class CardSession final {
+public:
+    /**
+     *
+     * @param terminal The terminal of the session.
+     * @param scheduler The scheduler executing the operations, must outlive the session.
+     */
+    CardSession(std::shared_ptr<CardTerminal> terminal, CardSessionScheduler& scheduler);
+
+    /**
+     * @return The terminal of the session.
+     */
+    std::shared_ptr<CardTerminal> getTerminal() const;
+
+    /**
+     * Awaitable CardTerminal::openAndConnect.
+     */
+    IoAwaitable<void> openAndConnect(const CardTerminal::ConnectionProtocol protocol,
+                                     const bool exclusive);
+
+    /**
+     * Awaitable CardTerminal::transmitApdu.
+     */
+    IoAwaitable<std::vector<uint8_t>> transmitApdu(std::vector<uint8_t> apdu);
+
+    /**
+     * Awaitable CardTerminal::transmitControlCommand.
+     */
+    IoAwaitable<std::vector<uint8_t>> transmitControlCommand(const int commandId,
+                                                             std::vector<uint8_t> command);
+
+    /**
+     * Awaitable CardTerminal::closeAndDisconnect.
+     */
+    IoAwaitable<void> closeAndDisconnect(const DisconnectionMode mode, const bool keepConnection);
+
+    /**
+     * Waits until a card is present or the timeout expires.
+     *
+     * @param timeout The maximum time to wait (in milliseconds), 0 to only check the current
+     *     state, negative for no limit.
+     * @return An awaitable resuming with true if a card is present, false if the timeout expired.
+     */
+    PresenceAwaitable waitForCardPresent(const long timeout);
+
+    /**
+     * Same as waitForCardPresent for the card removal.
+     */
+    PresenceAwaitable waitForCardAbsent(const long timeout);
+
+private:
+    /**
+     *
+     */
+    const std::shared_ptr<CardTerminal> mTerminal;
+
+    /**
+     *
+     */
+    CardSessionScheduler& mScheduler;
+};
+
+}
+}
+}
+}
@@ -0,0 +1,295 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include "CardSessionScheduler.h"
+
+#include <algorithm>
+
+namespace keyple {
+namespace plugin {
+namespace pcsc {
+namespace coroutine {
+
+const long CardSessionScheduler::IDLE_TERMINAL_TIMEOUT = 30000;
+
+CardSessionScheduler::CardSessionScheduler(const size_t ioThreadCount)
+: mIoExecutor(ioThreadCount),
+  mIsStopped(false),
+  mIsTimerRunning(true),
+  mMonitor(new CardTerminalMonitor())
+{
+    mTimerThread = std::thread(&CardSessionScheduler::runTimer, this);
+}
+
+CardSessionScheduler::~CardSessionScheduler()
+{
+    /* Stopped first, the timer removes the idle terminals from the monitor */
+    {
+        std::lock_guard<std::mutex> lock(mTimerMutex);
+        mIsTimerRunning = false;
+        mTimerCondition.notify_all();
+    }
+
+    if (mTimerThread.joinable()) {
+        mTimerThread.join();
+    }
+
+    /* No presence notification once the monitor is gone */
+    mMonitor.reset();
+
+    std::map<std::string, std::shared_ptr<TerminalWaits>> terminals;
+    {
+        std::lock_guard<std::mutex> lock(mTerminalsMutex);
+        mIsStopped = true;
+        terminals.swap(mTerminals);
+    }
+
+    /* Resumed with an error rather than leaked with their coroutine frames */
+    for (const auto& terminal : terminals) {
+        terminal.second->cancel();
+    }
+
+    /* The resumed coroutines may still queue operations, executed until they are all done */
+    mIoExecutor.waitUntilIdle();
+}
+
+void CardSessionScheduler::execute(const std::function<void()>& operation)
+{
+    mIoExecutor.execute(operation);
+}
+
+void CardSessionScheduler::waitForCardPresence(const std::string& terminalName,
+                                               std::shared_ptr<PresenceWait> wait,
+                                               const long timeout)
+{
+    /* Set before the timer can find the wait */
+    wait->terminalName = terminalName;
+
+    if (timeout > 0) {
+        std::lock_guard<std::mutex> lock(mTimerMutex);
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+        const bool isFirst = mDeadlines.empty() || deadline < mDeadlines.begin()->first;
+
+        mDeadlines.emplace(deadline, wait);
+        if (isFirst) {
+            mTimerCondition.notify_all();
+        }
+    }
+
+    /* Under the lock, the terminal can not be found idle and removed meanwhile */
+    std::lock_guard<std::mutex> lock(mTerminalsMutex);
+
+    if (mIsStopped) {
+        complete(wait, false, true);
+        return;
+    }
+
+    std::shared_ptr<TerminalWaits>& terminalWaits = mTerminals[terminalName];
+    const bool isNew = !terminalWaits;
+    if (isNew) {
+        terminalWaits = std::make_shared<TerminalWaits>(*this);
+    }
+
+    terminalWaits->add(wait);
+
+    if (isNew) {
+        /* The current presence is notified as soon as it is known */
+        mLogger->debug("[%] monitoring the card presence for the card sessions\n", terminalName);
+        mMonitor->addTerminal(terminalName, terminalWaits);
+    }
+}
+
+void CardSessionScheduler::complete(const std::shared_ptr<PresenceWait>& wait,
+                                    const bool isReached,
+                                    const bool isCancelled)
+{
+    if (wait->isCompleted.exchange(true)) {
+        return;
+    }
+
+    wait->isReached = isReached;
+    wait->isCancelled = isCancelled;
+
+    const std::coroutine_handle<> handle = wait->handle;
+    mIoExecutor.execute([handle]() { handle.resume(); });
+}
+
+void CardSessionScheduler::runTimer()
+{
+    const std::chrono::milliseconds idleTimeout(IDLE_TERMINAL_TIMEOUT);
+    auto nextIdleCheckTime = std::chrono::steady_clock::now() + idleTimeout;
+
+    std::unique_lock<std::mutex> lock(mTimerMutex);
+
+    while (mIsTimerRunning) {
+        const auto now = std::chrono::steady_clock::now();
+
+        if (now >= nextIdleCheckTime) {
+            lock.unlock();
+            removeIdleTerminals();
+            lock.lock();
+            nextIdleCheckTime = now + idleTimeout;
+            continue;
+        }
+
+        if (mDeadlines.empty()) {
+            mTimerCondition.wait_until(lock, nextIdleCheckTime);
+            continue;
+        }
+
+        const auto deadline = mDeadlines.begin()->first;
+        if (now < deadline) {
+            mTimerCondition.wait_until(lock, std::min(deadline, nextIdleCheckTime));
+            continue;
+        }
+
+        const std::shared_ptr<PresenceWait> wait = mDeadlines.begin()->second.lock();
+        mDeadlines.erase(mDeadlines.begin());
+
+        if (wait) {
+            lock.unlock();
+            complete(wait, false);
+
+            /* Not kept by the terminal until its next presence event */
+            {
+                std::lock_guard<std::mutex> terminalsLock(mTerminalsMutex);
+                const auto it = mTerminals.find(wait->terminalName);
+                if (it != mTerminals.end()) {
+                    it->second->remove(wait);
+                }
+            }
+
+            lock.lock();
+        }
+    }
+}
+
+void CardSessionScheduler::removeIdleTerminals()
+{
+    const auto now = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(mTerminalsMutex);
+
+    auto it = mTerminals.begin();
+    while (it != mTerminals.end()) {
+        if (!it->second->isIdle(now, std::chrono::milliseconds(IDLE_TERMINAL_TIMEOUT))) {
+            ++it;
+            continue;
+        }
+
+        mLogger->debug("[%] no card session waiting, stop monitoring the card presence\n",
+                       it->first);
+        mMonitor->removeTerminal(it->first);
+        it = mTerminals.erase(it);
+    }
+}
+
+CardSessionScheduler::TerminalWaits::TerminalWaits(CardSessionScheduler& scheduler)
+: mScheduler(scheduler),
+  mIsPresenceKnown(false),
+  mIsCardPresent(false),
+  mLastAddTime(std::chrono::steady_clock::now()) {}
+
+void CardSessionScheduler::TerminalWaits::onCardInserted(const std::vector<uint8_t>& atr)
+{
+    (void)atr;
+
+    update(true);
+}
+
+void CardSessionScheduler::TerminalWaits::onCardRemoved()
+{
+    update(false);
+}
+
+void CardSessionScheduler::TerminalWaits::add(std::shared_ptr<PresenceWait> wait)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        mLastAddTime = std::chrono::steady_clock::now();
+
+        if (!mIsPresenceKnown || mIsCardPresent != wait->present) {
+            /* Drops the waits completed by their timeout meanwhile */
+            mWaits.erase(std::remove_if(mWaits.begin(),
+                                        mWaits.end(),
+                                        [](const std::shared_ptr<PresenceWait>& pending) {
+                                            return pending->isCompleted.load();
+                                        }),
+                         mWaits.end());
+            mWaits.push_back(wait);
+            return;
+        }
+    }
+
+    mScheduler.complete(wait, true);
+}
+
+void CardSessionScheduler::TerminalWaits::remove(const std::shared_ptr<PresenceWait>& wait)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    mWaits.erase(std::remove(mWaits.begin(), mWaits.end(), wait), mWaits.end());
+}
+
+bool CardSessionScheduler::TerminalWaits::isIdle(const std::chrono::steady_clock::time_point now,
+                                                 const std::chrono::milliseconds idleTime)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    return mWaits.empty() && now - mLastAddTime >= idleTime;
+}
+
+void CardSessionScheduler::TerminalWaits::cancel()
+{
+    std::vector<std::shared_ptr<PresenceWait>> waits;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        waits.swap(mWaits);
+    }
+
+    for (const auto& wait : waits) {
+        mScheduler.complete(wait, false, true);
+    }
+}
+
+void CardSessionScheduler::TerminalWaits::update(const bool present)
+{
+    std::vector<std::shared_ptr<PresenceWait>> reached;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        mIsPresenceKnown = true;
+        mIsCardPresent = present;
+
+        /* Also drops the waits completed by their timeout */
+        auto it = mWaits.begin();
+        while (it != mWaits.end()) {
+            if ((*it)->present == present || (*it)->isCompleted) {
+                reached.push_back(*it);
+                it = mWaits.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    for (const auto& wait : reached) {
+        mScheduler.complete(wait, true);
+    }
+}
+
+}
+}
+}
+}
@@ -0,0 +1,279 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <typeinfo>
+#include <vector>
+
+/* Keyple Core Util */
+#include "LoggerFactory.h"
+
+/* Keyple Plugin Pcsc */
+#include "CardPresenceListener.h"
+#include "CardTerminalMonitor.h"
+#include "TaskExecutor.h"
+
+namespace keyple {
+namespace plugin {
+namespace pcsc {
+namespace coroutine {
+
+using namespace keyple::core::util::cpp;
+using namespace keyple::plugin::pcsc::cpp;
+
+/**
+ * Runs the card operations awaited by the card session coroutines.
+ *
+ * <p>The blocking PC/SC calls are executed by a bounded pool of I/O threads, which then resume the
+ * awaiting coroutine until its next suspension. The card presence waits block no thread: they are
+ * completed by the card presence events of a single {@link CardTerminalMonitor} or by a timer
+ * thread when their timeout expires.
+ *
+ * <p>A terminal is monitored from its first wait until it has had no pending wait for
+ * IDLE_TERMINAL_TIMEOUT, so that the readers no longer used (e.g. unplugged) are not polled
+ * forever.
+ *
+ * <p>The scheduler must outlive all the sessions using it. When it is destroyed, the pending card
+ * presence waits are resumed with an IllegalStateException, as are those started afterwards, and
+ * the queued operations are executed before the I/O threads stop.
+ */
+class CardSessionScheduler final {
+public:
+    /**
+     * State of a card presence wait, shared by the awaiting coroutine and its completion sources.
+     */
+    struct PresenceWait {
+        std::string terminalName;
+        std::coroutine_handle<> handle;
+        bool present = true;
+        std::atomic<bool> isCompleted{false};
+        bool isReached = false;
+        bool isCancelled = false;
+    };
+
+    /**
+     *
+     * @param ioThreadCount The maximum number of PC/SC calls executed at the same time (at least 1).
+     */
+    explicit CardSessionScheduler(const size_t ioThreadCount);
+
+    /**
+     * Stops the timer and the monitor, resumes the pending waits as cancelled, then waits for the
+     * end of the operations before stopping the I/O threads.
+     */
+    ~CardSessionScheduler();
+
+    /**
+     *
+     */
+    CardSessionScheduler(const CardSessionScheduler&) = delete;
+
+    /**
+     *
+     */
+    CardSessionScheduler& operator=(const CardSessionScheduler&) = delete;
+
+    /**
+     * Executes a blocking operation on an I/O thread.
+     *
+     * @param operation The operation, expected to resume a coroutine when done.
+     */
+    void execute(const std::function<void()>& operation);
+
+    /**
+     * Registers a card presence wait, completed as soon as the expected presence is notified for
+     * the terminal or when the timeout expires. The coroutine of the wait is then resumed on an I/O
+     * thread.
+     *
+     * @param terminalName The terminal name.
+     * @param wait The wait, with the coroutine to resume and the expected presence.
+     * @param timeout The maximum time to wait (in milliseconds), 0 or negative for no limit.
+     */
+    void waitForCardPresence(const std::string& terminalName,
+                             std::shared_ptr<PresenceWait> wait,
+                             const long timeout);
+
+private:
+    /**
+     * Card presence of a terminal and the waits pending on it.
+     */
+    class TerminalWaits final : public CardPresenceListener {
+    public:
+        /**
+         *
+         */
+        explicit TerminalWaits(CardSessionScheduler& scheduler);
+
+        /**
+         * {@inheritDoc}
+         */
+        void onCardInserted(const std::vector<uint8_t>& atr) override;
+
+        /**
+         * {@inheritDoc}
+         */
+        void onCardRemoved() override;
+
+        /**
+         * Adds a wait, completed immediately if the expected presence is already known.
+         */
+        void add(std::shared_ptr<PresenceWait> wait);
+
+        /**
+         * Removes a wait completed by its timeout.
+         */
+        void remove(const std::shared_ptr<PresenceWait>& wait);
+
+        /**
+         * Tells if no wait is pending and none has been added for the provided time.
+         */
+        bool isIdle(const std::chrono::steady_clock::time_point now,
+                    const std::chrono::milliseconds idleTime);
+
+        /**
+         * Completes all the pending waits as cancelled.
+         */
+        void cancel();
+
+    private:
+        /**
+         *
+         */
+        CardSessionScheduler& mScheduler;
+
+        /**
+         *
+         */
+        std::mutex mMutex;
+
+        /**
+         * False until the monitor has notified the current presence.
+         */
+        bool mIsPresenceKnown;
+
+        /**
+         *
+         */
+        bool mIsCardPresent;
+
+        /**
+         *
+         */
+        std::vector<std::shared_ptr<PresenceWait>> mWaits;
+
+        /**
+         *
+         */
+        std::chrono::steady_clock::time_point mLastAddTime;
+
+        /**
+         * Completes the waits expecting the notified presence.
+         */
+        void update(const bool present);
+    };
+
+    /**
+     * Time (in ms) without any wait after which a terminal is no longer monitored, also the
+     * period of the check.
+     */
+    static const long IDLE_TERMINAL_TIMEOUT;
+
+    /**
+     *
+     */
+    const std::unique_ptr<Logger> mLogger = LoggerFactory::getLogger(typeid(CardSessionScheduler));
+
+    /**
+     *
+     */
+    TaskExecutor mIoExecutor;
+
+    /**
+     * Also held while adding or removing a terminal from the monitor, so that both stay
+     * consistent.
+     */
+    std::mutex mTerminalsMutex;
+
+    /**
+     * Waits by terminal name, the terminal being monitored from its first wait until it is idle.
+     */
+    std::map<std::string, std::shared_ptr<TerminalWaits>> mTerminals;
+
+    /**
+     * Set by the destructor, the waits are then cancelled as soon as they start.
+     */
+    bool mIsStopped;
+
+    /**
+     * Guards the timer fields.
+     */
+    std::mutex mTimerMutex;
+
+    /**
+     *
+     */
+    std::condition_variable mTimerCondition;
+
+    /**
+     * Pending waits by deadline.
+     */
+    std::multimap<std::chrono::steady_clock::time_point, std::weak_ptr<PresenceWait>> mDeadlines;
+
+    /**
+     *
+     */
+    bool mIsTimerRunning;
+
+    /**
+     *
+     */
+    std::thread mTimerThread;
+
+    /**
+     * Declared last so that it stops notifying before the waits are destroyed.
+     */
+    std::unique_ptr<CardTerminalMonitor> mMonitor;
+
+    /**
+     * Completes a wait if not done yet and resumes its coroutine on an I/O thread.
+     */
+    void complete(const std::shared_ptr<PresenceWait>& wait,
+                  const bool isReached,
+                  const bool isCancelled = false);
+
+    /**
+     * Timer thread body, completes the waits whose deadline has passed and stops monitoring the
+     * idle terminals.
+     */
+    void runTimer();
+
+    /**
+     * Stops monitoring the terminals idle for IDLE_TERMINAL_TIMEOUT.
+     */
+    void removeIdleTerminals();
+};
+
+}
+}
+}
+}
@@ -0,0 +1,286 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <utility>
+
+namespace keyple {
+namespace plugin {
+namespace pcsc {
+namespace coroutine {
+
+template <typename T>
+class Task;
+
+namespace detail {
+
+/**
+ * Resumes the awaiting coroutine, if any, when a task completes.
+ */
+struct FinalAwaiter {
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    template <typename Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+    {
+        const std::coroutine_handle<> continuation = handle.promise().continuation;
+
+        return continuation ? continuation : std::noop_coroutine();
+    }
+
+    void await_resume() const noexcept {}
+};
+
+/**
+ * Promise fields common to all the task types.
+ */
+struct PromiseBase {
+    std::coroutine_handle<> continuation;
+    std::exception_ptr error;
+
+    std::suspend_always initial_suspend() const noexcept
+    {
+        return {};
+    }
+
+    FinalAwaiter final_suspend() const noexcept
+    {
+        return {};
+    }
+
+    void unhandled_exception() noexcept
+    {
+        error = std::current_exception();
+    }
+};
+
+template <typename T>
+struct Promise : PromiseBase {
+    std::optional<T> value;
+
+    Task<T> get_return_object() noexcept;
+
+    template <typename U>
+    void return_value(U&& result)
+    {
+        value.emplace(std::forward<U>(result));
+    }
+
+    T getResult()
+    {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+
+        return std::move(*value);
+    }
+};
+
+template <>
+struct Promise<void> : PromiseBase {
+    Task<void> get_return_object() noexcept;
+
+    void return_void() const noexcept {}
+
+    void getResult() const
+    {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+/**
+ * Coroutine started immediately and destroying itself once completed.
+ */
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() const noexcept
+        {
+            return {};
+        }
+
+        std::suspend_never initial_suspend() const noexcept
+        {
+            return {};
+        }
+
+        std::suspend_never final_suspend() const noexcept
+        {
+            return {};
+        }
+
+        void return_void() const noexcept {}
+
+        void unhandled_exception() const noexcept
+        {
+            std::terminate();
+        }
+    };
+};
+
+}
+
+/**
+ * Coroutine of a card session, producing a value of type T.
+ *
+ * <p>The coroutine is started lazily, when the task is awaited by another coroutine or started
+ * with spawn. The awaiting coroutine is resumed, on the thread completing the task, with the value
+ * returned or the exception thrown by the coroutine.
+ *
+ * <p>A task is move-only and can be awaited once.
+ */
+template <typename T = void>
+class Task final {
+public:
+    /**
+     *
+     */
+    using promise_type = detail::Promise<T>;
+
+    /**
+     *
+     */
+    explicit Task(std::coroutine_handle<promise_type> handle) noexcept : mHandle(handle) {}
+
+    /**
+     *
+     */
+    Task(Task&& other) noexcept : mHandle(std::exchange(other.mHandle, nullptr)) {}
+
+    /**
+     *
+     */
+    Task& operator=(Task&& other) noexcept
+    {
+        if (this != &other) {
+            if (mHandle) {
+                mHandle.destroy();
+            }
+
+            mHandle = std::exchange(other.mHandle, nullptr);
+        }
+
+        return *this;
+    }
+
+    /**
+     *
+     */
+    Task(const Task&) = delete;
+
+    /**
+     *
+     */
+    Task& operator=(const Task&) = delete;
+
+    /**
+     * Destroys the coroutine frame, the task must not be running.
+     */
+    ~Task()
+    {
+        if (mHandle) {
+            mHandle.destroy();
+        }
+    }
+
+    /**
+     * Awaiter starting the task and suspending the awaiting coroutine until it completes.
+     */
+    auto operator co_await() && noexcept
+    {
+        struct Awaiter {
+            std::coroutine_handle<promise_type> handle;
+
+            bool await_ready() const noexcept
+            {
+                return !handle || handle.done();
+            }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+            {
+                handle.promise().continuation = awaiting;
+
+                return handle;
+            }
+
+            T await_resume()
+            {
+                return handle.promise().getResult();
+            }
+        };
+
+        return Awaiter{mHandle};
+    }
+
+private:
+    /**
+     *
+     */
+    std::coroutine_handle<promise_type> mHandle;
+};
+
+namespace detail {
+
+template <typename T>
+Task<T> Promise<T>::get_return_object() noexcept
+{
+    return Task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+}
+
+inline Task<void> Promise<void>::get_return_object() noexcept
+{
+    return Task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+}
+
+}
+
+/**
+ * Starts a task on the calling thread, without waiting for its completion.
+ *
+ * <p>The calling thread runs the task until its first suspension, typically the first card
+ * operation.
+ *
+ * @param task The task to run.
+ * @param onCompleted Invoked once the task has completed, with the exception it has thrown if
+ *     any (optional, must not throw).
+ */
+template <typename T>
+void spawn(Task<T> task, std::function<void(std::exception_ptr error)> onCompleted = nullptr)
+{
+    [](Task<T> spawned,
+       std::function<void(std::exception_ptr)> callback) -> detail::DetachedTask {
+        std::exception_ptr error;
+        try {
+            co_await std::move(spawned);
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        if (callback) {
+            callback(error);
+        }
+    }(std::move(task), std::move(onCompleted));
+}
+
+}
+}
+}
+}
@@ -0,0 +1,253 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include "AnswerToReset.h"
+
+namespace keyple {
+namespace plugin {
+namespace pcsc {
+namespace cpp {
+
+/* ISO/IEC 7816-3 tables 7 and 8, 0 for the values reserved for future use */
+static const int FI_TABLE[16] = {
+    372, 372, 558, 744, 1116, 1488, 1860, 0, 0, 512, 768, 1024, 1536, 2048, 0, 0};
+static const int DI_TABLE[16] = {0, 1, 2, 4, 8, 16, 32, 64, 12, 20, 0, 0, 0, 0, 0, 0};
+
+/* PC/SC Part 3 storage card historical bytes: category indicator, application identifier tag */
+static const uint8_t STORAGE_CARD_CATEGORY = 0x80;
+static const uint8_t STORAGE_CARD_AID_TAG = 0x4F;
+static const size_t RID_LENGTH = 5;
+
+const int AnswerToReset::ABSENT = -1;
+
+AnswerToReset::AnswerToReset()
+: mIsValid(false),
+  mTs(0),
+  mT0(0),
+  mProtocols(0),
+  mHasTck(false),
+  mStandard(0),
+  mCardName(0) {}
+
+AnswerToReset::AnswerToReset(const std::vector<uint8_t>& atr) : AnswerToReset()
+{
+    mIsValid = parse(atr);
+
+    parseStorageCardFields();
+}
+
+bool AnswerToReset::parse(const std::vector<uint8_t>& atr)
+{
+    if (atr.size() < 2) {
+        return false;
+    }
+
+    mTs = atr[0];
+    mT0 = atr[1];
+
+    if (mTs != 0x3B && mTs != 0x3F) {
+        return false;
+    }
+
+    size_t offset = 2;
+    uint8_t indicator = mT0;
+    bool isTdPresent = true;
+
+    while (isTdPresent) {
+        InterfaceBytes interfaceBytes = {ABSENT, ABSENT, ABSENT, ABSENT};
+        int* bytes[] = {&interfaceBytes.ta,
+                        &interfaceBytes.tb,
+                        &interfaceBytes.tc,
+                        &interfaceBytes.td};
+
+        for (int i = 0; i < 4; i++) {
+            if ((indicator & (0x10 << i)) == 0) {
+                continue;
+            }
+
+            if (offset >= atr.size()) {
+                mInterfaceBytes.push_back(interfaceBytes);
+                return false;
+            }
+
+            *bytes[i] = atr[offset++];
+        }
+
+        mInterfaceBytes.push_back(interfaceBytes);
+
+        isTdPresent = interfaceBytes.td != ABSENT;
+        if (isTdPresent) {
+            indicator = static_cast<uint8_t>(interfaceBytes.td);
+
+            const int protocol = indicator & 0x0F;
+            if (protocol != 15) {
+                mProtocols |= static_cast<uint16_t>(1 << protocol);
+            }
+
+            /* TCK is absent only when T=0 is the only protocol indicated */
+            mHasTck = mHasTck || protocol != 0;
+        }
+    }
+
+    if (mInterfaceBytes[0].td == ABSENT) {
+        mProtocols = 1;
+    }
+
+    const size_t historicalBytesLength = mT0 & 0x0F;
+    if (offset + historicalBytesLength > atr.size()) {
+        return false;
+    }
+
+    mHistoricalBytes.assign(atr.begin() + offset, atr.begin() + offset + historicalBytesLength);
+    offset += historicalBytesLength;
+
+    if (mHasTck) {
+        if (offset >= atr.size()) {
+            return false;
+        }
+
+        /* The exclusive-or of the bytes from T0 to TCK is null */
+        uint8_t check = 0;
+        for (size_t i = 1; i <= offset; i++) {
+            check ^= atr[i];
+        }
+
+        if (check != 0) {
+            return false;
+        }
+
+        offset++;
+    }
+
+    return offset == atr.size();
+}
+
+void AnswerToReset::parseStorageCardFields()
+{
+    const std::vector<uint8_t>& bytes = mHistoricalBytes;
+
+    /* 80 4F LL RID(5) SS NN NN ... */
+    if (bytes.size() < 3 + RID_LENGTH + 3 ||
+        bytes[0] != STORAGE_CARD_CATEGORY ||
+        bytes[1] != STORAGE_CARD_AID_TAG ||
+        bytes[2] < RID_LENGTH + 3 ||
+        bytes.size() < 3 + static_cast<size_t>(bytes[2])) {
+        return;
+    }
+
+    mRid.assign(bytes.begin() + 3, bytes.begin() + 3 + RID_LENGTH);
+    mStandard = bytes[3 + RID_LENGTH];
+    mCardName = static_cast<uint16_t>((bytes[4 + RID_LENGTH] << 8) | bytes[5 + RID_LENGTH]);
+}
+
+bool AnswerToReset::isValid() const
+{
+    return mIsValid;
+}
+
+uint8_t AnswerToReset::getTs() const
+{
+    return mTs;
+}
+
+uint8_t AnswerToReset::getT0() const
+{
+    return mT0;
+}
+
+int AnswerToReset::getInterfaceByte(const size_t level, int InterfaceBytes::* byte) const
+{
+    if (level == 0 || level > mInterfaceBytes.size()) {
+        return ABSENT;
+    }
+
+    return mInterfaceBytes[level - 1].*byte;
+}
+
+int AnswerToReset::getTa(const size_t level) const
+{
+    return getInterfaceByte(level, &InterfaceBytes::ta);
+}
+
+int AnswerToReset::getTb(const size_t level) const
+{
+    return getInterfaceByte(level, &InterfaceBytes::tb);
+}
+
+int AnswerToReset::getTc(const size_t level) const
+{
+    return getInterfaceByte(level, &InterfaceBytes::tc);
+}
+
+int AnswerToReset::getTd(const size_t level) const
+{
+    return getInterfaceByte(level, &InterfaceBytes::td);
+}
+
+uint16_t AnswerToReset::getProtocols() const
+{
+    return mProtocols;
+}
+
+bool AnswerToReset::isProtocolOffered(const int protocol) const
+{
+    return protocol >= 0 && protocol < 16 && (mProtocols & (1 << protocol)) != 0;
+}
+
+int AnswerToReset::getFi() const
+{
+    const int ta1 = getTa(1);
+
+    return ta1 == ABSENT ? 372 : FI_TABLE[ta1 >> 4];
+}
+
+int AnswerToReset::getDi() const
+{
+    const int ta1 = getTa(1);
+
+    return ta1 == ABSENT ? 1 : DI_TABLE[ta1 & 0x0F];
+}
+
+const std::vector<uint8_t>& AnswerToReset::getHistoricalBytes() const
+{
+    return mHistoricalBytes;
+}
+
+bool AnswerToReset::hasTck() const
+{
+    return mHasTck;
+}
+
+bool AnswerToReset::isStorageCard() const
+{
+    return !mRid.empty();
+}
+
+const std::vector<uint8_t>& AnswerToReset::getRid() const
+{
+    return mRid;
+}
+
+uint8_t AnswerToReset::getStandard() const
+{
+    return mStandard;
+}
+
+uint16_t AnswerToReset::getCardName() const
+{
+    return mCardName;
+}
+
+}
+}
+}
+}
@@ -0,0 +1,233 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Keyple Plugin Pcsc */
+#include "KeyplePluginPcscExport.h"
+
+namespace keyple {
+namespace plugin {
+namespace pcsc {
+namespace cpp {
+
+/**
+ * Fields of an ATR as defined by ISO/IEC 7816-3, decoded once when the card is connected.
+ *
+ * <p>When the historical bytes follow the PC/SC Part 3 format used by the readers to report the
+ * contactless storage cards (80 4F 0C RID SS NN NN 00 00 00 00), the registered identifier, the
+ * standard byte and the card name are decoded as well.
+ */
+class KEYPLEPLUGINPCSC_API AnswerToReset final {
+public:
+    /**
+     * Value returned for an absent interface byte.
+     */
+    static const int ABSENT;
+
+    /**
+     * Builds an invalid ATR.
+     */
+    AnswerToReset();
+
+    /**
+     * Decodes the provided ATR.
+     *
+     * <p>A malformed ATR is not rejected, the fields decoded before the error are kept and
+     * isValid returns false.
+     *
+     * @param atr The raw ATR.
+     */
+    explicit AnswerToReset(const std::vector<uint8_t>& atr);
+
+    /**
+     * @return True if the ATR is well formed (TCK included when present).
+     */
+    bool isValid() const;
+
+    /**
+     * @return The initial character TS (0x3B direct convention, 0x3F inverse convention).
+     */
+    uint8_t getTs() const;
+
+    /**
+     * @return The format byte T0.
+     */
+    uint8_t getT0() const;
+
+    /**
+     * Gets an interface byte.
+     *
+     * @param level The level of the interface byte, starting at 1 (TA1, TA2...).
+     * @return The value of the byte or ABSENT.
+     */
+    int getTa(const size_t level) const;
+
+    /**
+     * Same as getTa for TBi.
+     */
+    int getTb(const size_t level) const;
+
+    /**
+     * Same as getTa for TCi.
+     */
+    int getTc(const size_t level) const;
+
+    /**
+     * Same as getTa for TDi.
+     */
+    int getTd(const size_t level) const;
+
+    /**
+     * @return The transmission protocols offered by the card, bit n being set for T=n (T=0 when
+     *     no TD1 is present). T=15 denotes global interface bytes and is never set.
+     */
+    uint16_t getProtocols() const;
+
+    /**
+     * @param protocol The protocol number (e.g. 1 for T=1).
+     * @return True if the card offers the protocol.
+     */
+    bool isProtocolOffered(const int protocol) const;
+
+    /**
+     * @return The clock rate conversion integer Fi defined by TA1 (372 if TA1 is absent), 0 if
+     *     the value is reserved for future use.
+     */
+    int getFi() const;
+
+    /**
+     * @return The baud rate adjustment integer Di defined by TA1 (1 if TA1 is absent), 0 if the
+     *     value is reserved for future use.
+     */
+    int getDi() const;
+
+    /**
+     * @return The historical bytes.
+     */
+    const std::vector<uint8_t>& getHistoricalBytes() const;
+
+    /**
+     * @return True if a check byte TCK is present.
+     */
+    bool hasTck() const;
+
+    /**
+     * @return True if the historical bytes follow the PC/SC Part 3 storage card format.
+     */
+    bool isStorageCard() const;
+
+    /**
+     * @return The registered application provider identifier (5 bytes, A0 00 00 03 06 for PC/SC)
+     *     of a storage card, empty otherwise.
+     */
+    const std::vector<uint8_t>& getRid() const;
+
+    /**
+     * @return The PC/SC Part 3 standard byte SS of a storage card (e.g. 0x03 for ISO 14443 A
+     *     part 3), 0 otherwise.
+     */
+    uint8_t getStandard() const;
+
+    /**
+     * @return The PC/SC Part 3 card name NN NN of a storage card (e.g. 0x0001 for MIFARE Classic
+     *     1K), 0 otherwise.
+     */
+    uint16_t getCardName() const;
+
+private:
+    /**
+     * Interface bytes of a level, an absent byte being set to ABSENT.
+     */
+    struct InterfaceBytes {
+        int ta;
+        int tb;
+        int tc;
+        int td;
+    };
+
+    /**
+     *
+     */
+    bool mIsValid;
+
+    /**
+     *
+     */
+    uint8_t mTs;
+
+    /**
+     *
+     */
+    uint8_t mT0;
+
+    /**
+     *
+     */
+    std::vector<InterfaceBytes> mInterfaceBytes;
+
+    /**
+     *
+     */
+    uint16_t mProtocols;
+
+    /**
+     *
+     */
+    std::vector<uint8_t> mHistoricalBytes;
+
+    /**
+     *
+     */
+    bool mHasTck;
+
+    /**
+     *
+     */
+    std::vector<uint8_t> mRid;
+
+    /**
+     *
+     */
+    uint8_t mStandard;
+
+    /**
+     *
+     */
+    uint16_t mCardName;
+
+    /**
+     * Decodes the interface bytes, the historical bytes and the check byte.
+     *
+     * @return False if the ATR is malformed.
+     */
+    bool parse(const std::vector<uint8_t>& atr);
+
+    /**
+     * Decodes the PC/SC Part 3 fields of the historical bytes, if any.
+     */
+    void parseStorageCardFields();
+
+    /**
+     *
+     */
+    int getInterfaceByte(const size_t level, int InterfaceBytes::* byte) const;
+};
+
+}
+}
+}
+}
@@ -0,0 +1,420 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include "AtrDatabase.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+
+#if defined(WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/* Keyple Core Util */
+#include "IllegalArgumentException.h"
+#include "IllegalStateException.h"
+
+namespace keyple {
+namespace plugin {
+namespace pcsc {
+namespace cpp {
+
+using namespace keyple::core::util::cpp::exception;
+
+const char AtrDatabase::MAGIC[8] = {'K', 'P', 'A', 'T', 'R', 'D', 'B', '\0'};
+const uint32_t AtrDatabase::BYTE_ORDER_MARK = 0x01020304;
+const uint32_t AtrDatabase::VERSION = 2;
+const uint32_t AtrDatabase::NO_ENTRY = 0xFFFFFFFF;
+const uint32_t AtrDatabase::MAX_NODE_COUNT = 65536;
+
+/* Maps a whole file in memory, returns null on failure */
+static const uint8_t* mapFile(const std::string& path, size_t& size)
+{
+#if defined(WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
+    HANDLE file = CreateFileA(path.c_str(),
+                              GENERIC_READ,
+                              FILE_SHARE_READ,
+                              NULL,
+                              OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL,
+                              NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return nullptr;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        return nullptr;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (mapping == NULL) {
+        return nullptr;
+    }
+
+    /* The view keeps the mapping alive */
+    const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (data == NULL) {
+        return nullptr;
+    }
+
+    size = static_cast<size_t>(fileSize.QuadPart);
+
+    return static_cast<const uint8_t*>(data);
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0) {
+        close(fd);
+        return nullptr;
+    }
+
+    /* The mapping remains valid once the descriptor is closed */
+    void* data = mmap(NULL, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return nullptr;
+    }
+
+    size = static_cast<size_t>(fileStat.st_size);
+
+    return static_cast<const uint8_t*>(data);
+#endif
+}
+
+static int countBits(uint8_t value)
+{
+    int count = 0;
+    for (; value != 0; value &= value - 1) {
+        count++;
+    }
+
+    return count;
+}
+
+static void unmapFile(const uint8_t* data, const size_t size)
+{
+#if defined(WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
+    (void)size;
+    UnmapViewOfFile(data);
+#else
+    munmap(const_cast<uint8_t*>(data), size);
+#endif
+}
+
+AtrDatabase::AtrDatabase(const uint8_t* data, const size_t size)
+: mData(data),
+  mSize(size),
+  mHeader(nullptr),
+  mNodes(nullptr),
+  mEdges(nullptr),
+  mNames(nullptr),
+  mNameData(nullptr) {}
+
+AtrDatabase::~AtrDatabase()
+{
+    unmapFile(mData, mSize);
+}
+
+std::shared_ptr<AtrDatabase> AtrDatabase::open(const std::string& path)
+{
+    size_t size = 0;
+    const uint8_t* data = mapFile(path, size);
+    if (data == nullptr) {
+        throw IllegalArgumentException("Unable to map the ATR database " + path);
+    }
+
+    std::shared_ptr<AtrDatabase> database(new AtrDatabase(data, size));
+    if (!database->check()) {
+        throw IllegalArgumentException("Invalid ATR database " + path);
+    }
+
+    return database;
+}
+
+bool AtrDatabase::check()
+{
+    if (mSize < sizeof(Header)) {
+        return false;
+    }
+
+    mHeader = reinterpret_cast<const Header*>(mData);
+    if (memcmp(mHeader->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        mHeader->byteOrder != BYTE_ORDER_MARK ||
+        mHeader->version != VERSION ||
+        mHeader->nodeCount == 0) {
+        return false;
+    }
+
+    /* 64 bits arithmetic, the counts can not overflow */
+    const uint64_t nodesOffset = sizeof(Header);
+    const uint64_t edgesOffset = nodesOffset + uint64_t(mHeader->nodeCount) * sizeof(Node);
+    const uint64_t namesOffset = edgesOffset + uint64_t(mHeader->edgeCount) * sizeof(Edge);
+    const uint64_t nameDataOffset = namesOffset + uint64_t(mHeader->entryCount) * sizeof(Name);
+    if (nameDataOffset + mHeader->namesSize != mSize) {
+        return false;
+    }
+
+    mNodes = reinterpret_cast<const Node*>(mData + nodesOffset);
+    mEdges = reinterpret_cast<const Edge*>(mData + edgesOffset);
+    mNames = reinterpret_cast<const Name*>(mData + namesOffset);
+    mNameData = reinterpret_cast<const char*>(mData + nameDataOffset);
+
+    for (uint32_t i = 0; i < mHeader->nodeCount; i++) {
+        const Node& node = mNodes[i];
+        if (uint64_t(node.firstEdge) + node.edgeCount > mHeader->edgeCount ||
+            (node.entry != NO_ENTRY && node.entry >= mHeader->entryCount)) {
+            return false;
+        }
+
+        /* The lookup relies on sorted and disjoint byte ranges */
+        for (uint32_t j = 1; j < node.edgeCount; j++) {
+            if (mEdges[node.firstEdge + j - 1].last >= mEdges[node.firstEdge + j].first) {
+                return false;
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < mHeader->edgeCount; i++) {
+        if (mEdges[i].first > mEdges[i].last || mEdges[i].target >= mHeader->nodeCount) {
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < mHeader->entryCount; i++) {
+        if (uint64_t(mNames[i].offset) + mNames[i].length > mHeader->namesSize) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int AtrDatabase::lookup(const std::vector<uint8_t>& atr) const
+{
+    uint32_t node = 0;
+    int entry = mNodes[0].entry != NO_ENTRY ? static_cast<int>(mNodes[0].entry) : -1;
+
+    /* One node per ATR byte, the deepest entry wins */
+    for (const uint8_t byte : atr) {
+        const Node& current = mNodes[node];
+        const Edge* const first = mEdges + current.firstEdge;
+        const Edge* const end = first + current.edgeCount;
+        const Edge* const edge =
+            std::lower_bound(first, end, byte, [](const Edge& candidate, const uint8_t value) {
+                return candidate.last < value;
+            });
+
+        if (edge == end || edge->first > byte) {
+            break;
+        }
+
+        node = edge->target;
+        if (mNodes[node].entry != NO_ENTRY) {
+            entry = static_cast<int>(mNodes[node].entry);
+        }
+    }
+
+    return entry;
+}
+
+std::string AtrDatabase::getCardType(const int entry) const
+{
+    if (entry < 0 || static_cast<uint32_t>(entry) >= mHeader->entryCount) {
+        return "";
+    }
+
+    return std::string(mNameData + mNames[entry].offset, mNames[entry].length);
+}
+
+size_t AtrDatabase::getEntryCount() const
+{
+    return mHeader->entryCount;
+}
+
+void AtrDatabase::write(const std::string& path, const std::vector<Entry>& entries)
+{
+    write(path, entries, MAX_NODE_COUNT);
+}
+
+void AtrDatabase::write(const std::string& path,
+                        const std::vector<Entry>& entries,
+                        const uint32_t maxNodeCount)
+{
+    struct MaskedEdge {
+        uint8_t value;
+        uint8_t mask;
+        uint32_t target;
+    };
+
+    /* Trie of the masked prefixes, a byte may follow several of its edges */
+    struct MaskedNode {
+        std::vector<MaskedEdge> edges;
+        uint32_t entry;
+        uint32_t specificity;
+    };
+
+    std::vector<MaskedNode> maskedNodes(1, MaskedNode{{}, NO_ENTRY, 0});
+    std::vector<Name> names;
+    std::string nameData;
+
+    for (const Entry& entry : entries) {
+        if (!entry.mask.empty() && entry.mask.size() != entry.atr.size()) {
+            throw IllegalArgumentException("The mask of the ATR database entry " + entry.cardType +
+                                           " does not match its ATR length");
+        }
+
+        uint32_t node = 0;
+        for (size_t i = 0; i < entry.atr.size(); i++) {
+            const uint8_t mask = entry.mask.empty() ? 0xFF : entry.mask[i];
+            const uint8_t value = entry.atr[i] & mask;
+
+            std::vector<MaskedEdge>& edges = maskedNodes[node].edges;
+            auto it = std::find_if(edges.begin(), edges.end(), [&](const MaskedEdge& edge) {
+                return edge.value == value && edge.mask == mask;
+            });
+
+            if (it != edges.end()) {
+                node = it->target;
+            } else {
+                const uint32_t target = static_cast<uint32_t>(maskedNodes.size());
+                const uint32_t specificity = maskedNodes[node].specificity + countBits(mask);
+                edges.push_back({value, mask, target});
+                maskedNodes.push_back(MaskedNode{{}, NO_ENTRY, specificity});
+                node = target;
+            }
+        }
+
+        if (maskedNodes[node].entry == NO_ENTRY) {
+            maskedNodes[node].entry = static_cast<uint32_t>(names.size());
+            names.push_back({static_cast<uint32_t>(nameData.size()),
+                             static_cast<uint32_t>(entry.cardType.size())});
+            nameData += entry.cardType;
+        }
+    }
+
+    /*
+     * Subset construction: each node of the file stands for the set of masked nodes reached by
+     * the same bytes, so that the lookup follows a single edge per ATR byte
+     */
+    std::vector<std::vector<uint32_t>> states(1, std::vector<uint32_t>(1, 0));
+    std::map<std::vector<uint32_t>, uint32_t> stateIndexes;
+    stateIndexes[states[0]] = 0;
+
+    std::vector<Node> fileNodes;
+    std::vector<Edge> fileEdges;
+
+    for (size_t i = 0; i < states.size(); i++) {
+        /* Copied, states grows below */
+        const std::vector<uint32_t> state = states[i];
+
+        /* All the masked nodes of a state have the same depth, the most specific entry wins */
+        uint32_t stateEntry = NO_ENTRY;
+        uint32_t stateSpecificity = 0;
+        for (const uint32_t node : state) {
+            const MaskedNode& maskedNode = maskedNodes[node];
+            if (maskedNode.entry != NO_ENTRY &&
+                (stateEntry == NO_ENTRY ||
+                 maskedNode.specificity > stateSpecificity ||
+                 (maskedNode.specificity == stateSpecificity && maskedNode.entry < stateEntry))) {
+                stateEntry = maskedNode.entry;
+                stateSpecificity = maskedNode.specificity;
+            }
+        }
+
+        fileNodes.push_back({static_cast<uint32_t>(fileEdges.size()), 0, stateEntry});
+
+        /* The consecutive bytes leading to the same state share an edge */
+        std::vector<uint32_t> targets;
+        std::vector<uint32_t> previousTargets;
+        for (int byte = 0; byte < 256; byte++) {
+            targets.clear();
+            for (const uint32_t node : state) {
+                for (const MaskedEdge& edge : maskedNodes[node].edges) {
+                    if ((byte & edge.mask) == edge.value) {
+                        targets.push_back(edge.target);
+                    }
+                }
+            }
+
+            std::sort(targets.begin(), targets.end());
+
+            if (targets.empty()) {
+                previousTargets.clear();
+                continue;
+            }
+
+            if (targets == previousTargets) {
+                fileEdges.back().last = static_cast<uint8_t>(byte);
+                continue;
+            }
+
+            auto it = stateIndexes.find(targets);
+            if (it == stateIndexes.end()) {
+                /* Each mask overlapping another one may double the number of states */
+                if (states.size() >= std::min(maxNodeCount, MAX_NODE_COUNT)) {
+                    throw IllegalArgumentException(
+                        "The masks of the ATR database entries expand into more than " +
+                        std::to_string(std::min(maxNodeCount, MAX_NODE_COUNT)) + " nodes");
+                }
+
+                it = stateIndexes.emplace(targets, static_cast<uint32_t>(states.size())).first;
+                states.push_back(targets);
+            }
+
+            fileEdges.push_back(
+                {static_cast<uint8_t>(byte), static_cast<uint8_t>(byte), 0, it->second});
+            fileNodes.back().edgeCount++;
+            previousTargets.swap(targets);
+        }
+    }
+
+    Header header;
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.version = VERSION;
+    header.nodeCount = static_cast<uint32_t>(fileNodes.size());
+    header.edgeCount = static_cast<uint32_t>(fileEdges.size());
+    header.entryCount = static_cast<uint32_t>(names.size());
+    header.namesSize = static_cast<uint32_t>(nameData.size());
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(fileNodes.data()), fileNodes.size() * sizeof(Node));
+    file.write(reinterpret_cast<const char*>(fileEdges.data()), fileEdges.size() * sizeof(Edge));
+    file.write(reinterpret_cast<const char*>(names.data()), names.size() * sizeof(Name));
+    file.write(nameData.data(), nameData.size());
+    file.close();
+
+    if (!file) {
+        throw IllegalStateException("Unable to write the ATR database " + path);
+    }
+}
+
+}
+}
+}
+}
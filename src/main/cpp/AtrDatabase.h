@@ -0,0 +1,249 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/* Keyple Plugin Pcsc */
+#include "KeyplePluginPcscExport.h"
+
+namespace keyple {
+namespace plugin {
+namespace pcsc {
+namespace cpp {
+
+/**
+ * Read-only database identifying the card type from the ATR, memory-mapped from a binary file.
+ *
+ * <p>The file is produced offline by write() from a list of masked ATR prefixes, for instance with
+ * the keyplepluginpcscatrdb tool converting a text list. The masks are resolved when writing: the
+ * file holds a deterministic automaton whose nodes dispatch each byte value through sorted,
+ * disjoint byte ranges. Opening the database only maps the file and checks
+ * its indexes, and a lookup follows a single edge per byte of the ATR (a binary search among at
+ * most 256 ranges) whatever the number of entries.
+ *
+ * <p>An entry matches an ATR when the ATR starts with the entry bytes, each byte being compared
+ * through the entry mask. When several entries match, the longest one wins, then the one with the
+ * most specific masks (the most mask bits set), then the first one written.
+ *
+ * <p>The file layout (native byte order, checked when opening) is a 32 bytes header followed by
+ * the nodes, the edges, the entries and the card type names.
+ */
+class KEYPLEPLUGINPCSC_API AtrDatabase final {
+public:
+    /**
+     * Entry of the database to write.
+     */
+    struct Entry {
+        /**
+         * The ATR prefix.
+         */
+        std::vector<uint8_t> atr;
+
+        /**
+         * The mask applied on each byte of the prefix, empty to compare all the bits.
+         */
+        std::vector<uint8_t> mask;
+
+        /**
+         * The card type returned when the entry matches.
+         */
+        std::string cardType;
+    };
+
+    /**
+     * Maps a database file.
+     *
+     * @param path The path of a file produced by write().
+     * @return A not null reference.
+     * @throw IllegalArgumentException If the file can not be mapped or is not a valid database.
+     */
+    static std::shared_ptr<AtrDatabase> open(const std::string& path);
+
+    /**
+     * Writes a database file.
+     *
+     * <p>When several entries have the same masked prefix, the first one is kept. Overlapping
+     * masks are expanded into distinct nodes, the file may then hold more nodes than bytes of
+     * prefixes, up to MAX_NODE_COUNT.
+     *
+     * @param path The path of the file to create.
+     * @param entries The entries.
+     * @throw IllegalArgumentException If an entry mask and prefix have different lengths, or if
+     *     the masks expand into more than MAX_NODE_COUNT nodes.
+     * @throw IllegalStateException If the file can not be written.
+     */
+    static void write(const std::string& path, const std::vector<Entry>& entries);
+
+    /**
+     * Writes a database file of at most the provided number of nodes.
+     *
+     * @param path The path of the file to create.
+     * @param entries The entries.
+     * @param maxNodeCount The maximum number of nodes, at most MAX_NODE_COUNT.
+     * @throw IllegalArgumentException If an entry mask and prefix have different lengths, or if
+     *     the masks expand into more than maxNodeCount nodes.
+     * @throw IllegalStateException If the file can not be written.
+     */
+    static void write(const std::string& path,
+                      const std::vector<Entry>& entries,
+                      const uint32_t maxNodeCount);
+
+    /**
+     * Maximum number of nodes of a database, bounding the expansion of the overlapping masks.
+     */
+    static const uint32_t MAX_NODE_COUNT;
+
+    /**
+     * Unmaps the file.
+     */
+    ~AtrDatabase();
+
+    /**
+     * Finds the entry matching an ATR.
+     *
+     * @param atr The ATR.
+     * @return The index of the entry, -1 if no entry matches.
+     */
+    int lookup(const std::vector<uint8_t>& atr) const;
+
+    /**
+     * Gets the card type of an entry.
+     *
+     * @param entry An index returned by lookup.
+     * @return The card type, empty if the index is out of range.
+     */
+    std::string getCardType(const int entry) const;
+
+    /**
+     * @return The number of entries.
+     */
+    size_t getEntryCount() const;
+
+private:
+    /**
+     * File header.
+     */
+    struct Header {
+        char magic[8];
+        uint32_t byteOrder;
+        uint32_t version;
+        uint32_t nodeCount;
+        uint32_t edgeCount;
+        uint32_t entryCount;
+        uint32_t namesSize;
+    };
+
+    /**
+     * Automaton node, its edges being stored contiguously from firstEdge, sorted by byte range.
+     */
+    struct Node {
+        uint32_t firstEdge;
+        uint32_t edgeCount;
+        uint32_t entry;
+    };
+
+    /**
+     * Automaton edge, followed when first <= atr byte <= last.
+     */
+    struct Edge {
+        uint8_t first;
+        uint8_t last;
+        uint16_t reserved;
+        uint32_t target;
+    };
+
+    /**
+     * Card type name location in the names area.
+     */
+    struct Name {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    /**
+     *
+     */
+    static const char MAGIC[8];
+
+    /**
+     *
+     */
+    static const uint32_t BYTE_ORDER_MARK;
+
+    /**
+     *
+     */
+    static const uint32_t VERSION;
+
+    /**
+     * Entry index of a node not ending any entry.
+     */
+    static const uint32_t NO_ENTRY;
+
+    /**
+     *
+     */
+    const uint8_t* mData;
+
+    /**
+     *
+     */
+    size_t mSize;
+
+    /**
+     *
+     */
+    const Header* mHeader;
+
+    /**
+     *
+     */
+    const Node* mNodes;
+
+    /**
+     *
+     */
+    const Edge* mEdges;
+
+    /**
+     *
+     */
+    const Name* mNames;
+
+    /**
+     *
+     */
+    const char* mNameData;
+
+    /**
+     *
+     */
+    AtrDatabase(const uint8_t* data, const size_t size);
+
+    /**
+     * Checks the header and all the indexes of the mapped file.
+     *
+     * @return False if the file is not a valid database.
+     */
+    bool check();
+};
+
+}
+}
+}
+}
@@ -0,0 +1,142 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include "CardContextManager.h"
+
+/* PC/SC plugin */
+#include "CardTerminalException.h"
+
+namespace keyple {
+namespace plugin {
+namespace pcsc {
+namespace cpp {
+
+using namespace keyple::plugin::pcsc::cpp::exception;
+
+#ifdef WIN32
+std::string pcsc_stringify_error(LONG rv);
+#endif
+
+const std::string CardContextManager::ENUMERATION = "";
+
+CardContextManager::CardContextManager() {}
+
+CardContextManager::~CardContextManager()
+{
+    for (const auto& entry : mContexts) {
+        SCardReleaseContext(entry.second);
+    }
+}
+
+std::shared_ptr<CardContextManager> CardContextManager::getInstance()
+{
+    static const std::shared_ptr<CardContextManager> instance(new CardContextManager());
+
+    return instance;
+}
+
+SCARDCONTEXT CardContextManager::getContext(const std::string& owner)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    const auto it = mContexts.find(owner);
+    if (it != mContexts.end()) {
+        if (SCardIsValidContext(it->second) == SCARD_S_SUCCESS) {
+            return it->second;
+        }
+
+        mLogger->debug("[%] context no longer valid, establishing a new one\n", owner);
+
+        SCardReleaseContext(it->second);
+        mContexts.erase(it);
+    }
+
+    SCARDCONTEXT context;
+    LONG rv = SCardEstablishContext(SCARD_SCOPE_USER, NULL, NULL, &context);
+    if (rv != SCARD_S_SUCCESS) {
+        mLogger->error("SCardEstablishContext failed with error: %\n",
+                       std::string(pcsc_stringify_error(rv)));
+        throw CardTerminalException("SCardEstablishContext failed");
+    }
+
+    mContexts.insert({owner, context});
+
+    return context;
+}
+
+bool CardContextManager::handleError(const std::string& owner, const LONG rv)
+{
+    if (rv == SCARD_S_SUCCESS) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    const auto it = mContexts.find(owner);
+    if (it == mContexts.end()) {
+        return false;
+    }
+
+    /* PC/SC reports an invalid context and an invalid card handle with the same error, so apart
+       from a dead service the context is only released if PC/SC no longer considers it valid */
+    if (!isContextLost(rv) && SCardIsValidContext(it->second) == SCARD_S_SUCCESS) {
+        return false;
+    }
+
+    mLogger->debug("[%] releasing the context after error %\n",
+                   owner,
+                   std::string(pcsc_stringify_error(rv)));
+
+    SCardReleaseContext(it->second);
+    mContexts.erase(it);
+
+    return true;
+}
+
+void CardContextManager::addTerminal(const std::string& owner)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    mTerminalCounts[owner]++;
+}
+
+void CardContextManager::removeTerminal(const std::string& owner)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    const auto count = mTerminalCounts.find(owner);
+    if (count == mTerminalCounts.end() || --count->second > 0) {
+        return;
+    }
+
+    mTerminalCounts.erase(count);
+
+    const auto it = mContexts.find(owner);
+    if (it == mContexts.end()) {
+        return;
+    }
+
+    mLogger->debug("[%] releasing the context, no terminal left\n", owner);
+
+    SCardReleaseContext(it->second);
+    mContexts.erase(it);
+}
+
+bool CardContextManager::isContextLost(const LONG rv)
+{
+    return rv == SCARD_E_NO_SERVICE || rv == SCARD_E_SERVICE_STOPPED;
+}
+
+}
+}
+}
+}
@@ -0,0 +1,151 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeinfo>
+
+/* Keyple Core Util */
+#include "LoggerFactory.h"
+
+/* Keyple Plugin Pcsc */
+#include "KeyplePluginPcscExport.h"
+
+/* PC/SC */
+#if defined(WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
+#include <winscard.h>
+#else
+#include <PCSC/winscard.h>
+#include <PCSC/wintypes.h>
+#endif
+
+namespace keyple {
+namespace plugin {
+namespace pcsc {
+namespace cpp {
+
+using namespace keyple::core::util::cpp;
+
+/**
+ * Keeps the PC/SC contexts alive across the card sessions and the reader enumerations.
+ *
+ * <p>Each owner (a reader name, or ENUMERATION for the reader list) gets its own long-lived
+ * context, so that establishing a context no longer costs a round trip to the PC/SC service for
+ * every session, and so that the readers do not share a context (pcsc-lite serializes the calls
+ * made on a same context).
+ *
+ * <p>A context is checked with SCardIsValidContext before being handed out and is established
+ * again once the PC/SC service has been reported lost (e.g. SCARD_E_NO_SERVICE).
+ */
+class KEYPLEPLUGINPCSC_API CardContextManager final {
+public:
+    /**
+     * Owner of the context used to enumerate the readers.
+     */
+    static const std::string ENUMERATION;
+
+    /**
+     * Gets the unique instance.
+     *
+     * <p>Holding the returned reference keeps the contexts alive.
+     *
+     * @return A not null reference.
+     */
+    static std::shared_ptr<CardContextManager> getInstance();
+
+    /**
+     * Releases all the contexts.
+     */
+    ~CardContextManager();
+
+    /**
+     * Gets the context of the provided owner, establishes it if needed.
+     *
+     * @param owner The owner of the context.
+     * @return A valid context.
+     * @throw CardTerminalException If the context could not be established.
+     */
+    SCARDCONTEXT getContext(const std::string& owner);
+
+    /**
+     * Takes into account an error returned by a PC/SC call made with the context of the provided
+     * owner.
+     *
+     * <p>If the error means that the service is stopped or unavailable, or if SCardIsValidContext
+     * rejects the context, the context is released and a new one will be established by the next
+     * getContext call. Other errors, such as a stale card handle, leave the context untouched.
+     *
+     * @param owner The owner of the context.
+     * @param rv The PC/SC error code.
+     * @return True if the context has been released.
+     */
+    bool handleError(const std::string& owner, const LONG rv);
+
+    /**
+     * Registers a terminal using the context of the provided owner.
+     *
+     * @param owner The owner of the context (the terminal name).
+     */
+    void addTerminal(const std::string& owner);
+
+    /**
+     * Unregisters a terminal using the context of the provided owner.
+     *
+     * <p>The context is released once no terminal of the owner remains, so that the readers
+     * unplugged or renamed by their driver do not keep a context.
+     *
+     * @param owner The owner of the context (the terminal name).
+     */
+    void removeTerminal(const std::string& owner);
+
+private:
+    /**
+     *
+     */
+    const std::unique_ptr<Logger> mLogger = LoggerFactory::getLogger(typeid(CardContextManager));
+
+    /**
+     *
+     */
+    std::mutex mMutex;
+
+    /**
+     *
+     */
+    std::map<std::string, SCARDCONTEXT> mContexts;
+
+    /**
+     * Number of terminals per owner, the contexts of the owners absent from this map (e.g.
+     * ENUMERATION) are kept until the end.
+     */
+    std::map<std::string, size_t> mTerminalCounts;
+
+    /**
+     *
+     */
+    CardContextManager();
+
+    /**
+     * Tells if the provided error means that the context must be established again, regardless of
+     * what SCardIsValidContext reports.
+     */
+    static bool isContextLost(const LONG rv);
+};
+
+}
+}
+}
+}
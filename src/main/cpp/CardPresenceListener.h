@@ -0,0 +1,73 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/* Keyple Plugin Pcsc */
+#include "KeyplePluginPcscExport.h"
+
+namespace keyple {
+namespace plugin {
+namespace pcsc {
+namespace cpp {
+
+/**
+ * Receives the card presence changes detected by a {@link CardTerminalMonitor} for a given
+ * terminal.
+ *
+ * <p>Notifications are made from the monitoring thread, implementations must return quickly and
+ * must not call back the monitor.
+ */
+class KEYPLEPLUGINPCSC_API CardPresenceListener {
+public:
+    /**
+     *
+     */
+    virtual ~CardPresenceListener() = default;
+
+    /**
+     * Invoked when a card has been inserted in the terminal (or was already present when the
+     * terminal was registered).
+     *
+     * @param atr The ATR of the card reported by the PC/SC service, obtained without connecting
+     *     to the card (may be empty if the service does not provide it).
+     */
+    virtual void onCardInserted(const std::vector<uint8_t>& atr) = 0;
+
+    /**
+     * Invoked when the card has been removed from the terminal (or was already absent when the
+     * terminal was registered).
+     */
+    virtual void onCardRemoved() = 0;
+
+    /**
+     * Invoked when the monitor fails to get the card presence (e.g. PC/SC service stopped or
+     * context lost). The monitor retries, and notifies the card presence again once recovered.
+     *
+     * <p>Does nothing by default.
+     *
+     * @param reason The PC/SC error.
+     */
+    virtual void onMonitoringFailed(const std::string& reason)
+    {
+        (void)reason;
+    }
+};
+
+}
+}
+}
+}
@@ -0,0 +1,231 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include "CardPresenceTracker.h"
+
+#include <chrono>
+
+/* Keyple Plugin Pcsc */
+#include "CardException.h"
+
+namespace keyple {
+namespace plugin {
+namespace pcsc {
+namespace cpp {
+
+using namespace keyple::plugin::pcsc::cpp::exception;
+
+CardPresenceTracker::Waiter::Waiter()
+: blockedCount(0),
+  cancellationCount(0),
+  isCancellationPending(false),
+  isReached(false) {}
+
+CardPresenceTracker::CardPresenceTracker()
+: mIsPresenceKnown(false),
+  mIsCardPresent(false),
+  mIsMonitoringFailed(false),
+  mInsertionCount(0),
+  mRemovalCount(0) {}
+
+void CardPresenceTracker::onCardInserted(const std::vector<uint8_t>& atr)
+{
+    bool isAccepted = true;
+
+    {
+        std::lock_guard<std::mutex> lock(mInsertionFilterMutex);
+
+        if (mInsertionFilter) {
+            isAccepted = mInsertionFilter(atr);
+        }
+    }
+
+    std::shared_ptr<CardPresenceListener> nextListener;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        mIsPresenceKnown = true;
+        mIsCardPresent = isAccepted;
+        mIsMonitoringFailed = false;
+
+        if (!isAccepted) {
+            return;
+        }
+
+        mInsertionCount++;
+
+        mCondition.notify_all();
+
+        nextListener = mNextListener;
+    }
+
+    if (nextListener) {
+        nextListener->onCardInserted(atr);
+    }
+}
+
+void CardPresenceTracker::onCardRemoved()
+{
+    std::shared_ptr<CardPresenceListener> nextListener;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        mIsPresenceKnown = true;
+        mIsCardPresent = false;
+        mIsMonitoringFailed = false;
+        mRemovalCount++;
+
+        mCondition.notify_all();
+
+        nextListener = mNextListener;
+    }
+
+    if (nextListener) {
+        nextListener->onCardRemoved();
+    }
+}
+
+void CardPresenceTracker::onMonitoringFailed(const std::string& reason)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    mIsMonitoringFailed = true;
+    mMonitoringFailureReason = reason;
+
+    mCondition.notify_all();
+}
+
+void CardPresenceTracker::setNextListener(std::shared_ptr<CardPresenceListener> listener)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    mNextListener = listener;
+}
+
+void CardPresenceTracker::setInsertionFilter(
+    std::function<bool(const std::vector<uint8_t>&)> filter)
+{
+    std::lock_guard<std::mutex> lock(mInsertionFilterMutex);
+
+    mInsertionFilter = filter;
+}
+
+void CardPresenceTracker::reset()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    mIsPresenceKnown = false;
+    mIsMonitoringFailed = false;
+}
+
+bool CardPresenceTracker::getLastCardPresence(bool& isCardPresent)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (!mIsPresenceKnown) {
+        return false;
+    }
+
+    isCardPresent = mIsCardPresent;
+
+    return true;
+}
+
+void CardPresenceTracker::cancel(const bool present)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    Waiter& waiter = mWaiters[present];
+
+    waiter.cancellationCount++;
+
+    /* Not lost if the next wait has not started yet */
+    if (waiter.blockedCount == 0 && !waiter.isReached) {
+        waiter.isCancellationPending = true;
+    }
+
+    mCondition.notify_all();
+}
+
+CardPresenceTracker::WaitResult CardPresenceTracker::waitForCardPresence(const bool present,
+                                                                         const long timeout)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    Waiter& waiter = mWaiters[present];
+    Waiter& oppositeWaiter = mWaiters[!present];
+
+    /* A cancellation kept for the opposite presence targeted a wait that will not come anymore */
+    oppositeWaiter.isCancellationPending = false;
+    oppositeWaiter.isReached = false;
+    waiter.isReached = false;
+
+    if (waiter.isCancellationPending) {
+        waiter.isCancellationPending = false;
+        return WaitResult::CANCELLED;
+    }
+
+    if (mIsMonitoringFailed) {
+        throw CardException("Card presence monitoring failed: " +
+                            mMonitoringFailureReason);
+    }
+
+    const uint64_t insertionCount = mInsertionCount;
+    const uint64_t removalCount = mRemovalCount;
+    const uint64_t cancellationCount = waiter.cancellationCount;
+
+    waiter.blockedCount++;
+
+    mCondition.wait_for(lock, std::chrono::milliseconds(timeout), [&]() {
+        if (waiter.cancellationCount != cancellationCount || mIsMonitoringFailed) {
+            return true;
+        }
+
+        if (!mIsPresenceKnown) {
+            return false;
+        }
+
+        return present ? mIsCardPresent || mInsertionCount != insertionCount
+                       : !mIsCardPresent || mRemovalCount != removalCount;
+    });
+
+    waiter.blockedCount--;
+
+    if (waiter.cancellationCount != cancellationCount) {
+        return WaitResult::CANCELLED;
+    }
+
+    if (mIsMonitoringFailed) {
+        throw CardException("Card presence monitoring failed: " +
+                            mMonitoringFailureReason);
+    }
+
+    if (!mIsPresenceKnown) {
+        return WaitResult::TIMED_OUT;
+    }
+
+    if (present ? !mIsCardPresent && mInsertionCount == insertionCount
+                : mIsCardPresent && mRemovalCount == removalCount) {
+        return WaitResult::TIMED_OUT;
+    }
+
+    waiter.isReached = true;
+
+    return WaitResult::REACHED;
+}
+
+}
+}
+}
+}
@@ -0,0 +1,237 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/* Keyple Plugin Pcsc */
+#include "CardPresenceListener.h"
+#include "KeyplePluginPcscExport.h"
+
+namespace keyple {
+namespace plugin {
+namespace pcsc {
+namespace cpp {
+
+/**
+ * {@link CardPresenceListener} keeping the last card presence notified by the monitor and
+ * allowing threads to block until it changes.
+ */
+class KEYPLEPLUGINPCSC_API CardPresenceTracker : public CardPresenceListener {
+public:
+    /**
+     * Outcome of waitForCardPresence.
+     */
+    enum class WaitResult {
+        /**
+         * The expected card presence was reached.
+         */
+        REACHED,
+        /**
+         * The timeout expired.
+         */
+        TIMED_OUT,
+        /**
+         * The wait was cancelled.
+         */
+        CANCELLED
+    };
+
+    /**
+     *
+     */
+    CardPresenceTracker();
+
+    /**
+     * {@inheritDoc}
+     *
+     * <p>An insertion rejected by the insertion filter is handled as if the card were absent: it
+     * neither ends the waits for a card insertion nor is forwarded.
+     */
+    void onCardInserted(const std::vector<uint8_t>& atr) override;
+
+    /**
+     * {@inheritDoc}
+     */
+    void onCardRemoved() override;
+
+    /**
+     * {@inheritDoc}
+     *
+     * <p>The waits fail until the card presence is notified again.
+     */
+    void onMonitoringFailed(const std::string& reason) override;
+
+    /**
+     * Blocks until the expected card presence is reached or the timeout expires.
+     *
+     * <p>An insertion (resp. removal) notified after the call started is considered as reached
+     * even if the card has been removed (resp. inserted) again since.
+     *
+     * <p>A cancellation of the waits for this presence requested while no thread was blocked is
+     * consumed by the next call, which returns immediately.
+     *
+     * @param present The expected card presence.
+     * @param timeout The maximum time to wait (in milliseconds).
+     * @return The outcome of the wait.
+     * @throw CardException If the monitor has failed to get the card presence and has not
+     *     recovered yet.
+     */
+    WaitResult waitForCardPresence(const bool present, const long timeout);
+
+    /**
+     * Gets the last card presence notified by the monitor.
+     *
+     * @param isCardPresent Set to the last notified card presence.
+     * @return False if the monitor has not notified the card presence yet, in which case
+     *     isCardPresent is left unchanged.
+     */
+    bool getLastCardPresence(bool& isCardPresent);
+
+    /**
+     * Immediately releases the threads currently blocked in waitForCardPresence for the provided
+     * presence.
+     *
+     * <p>If none is blocked, the cancellation is kept for the next wait for this presence, unless
+     * the last one has reached it: the cancellation then targets a wait already over and is
+     * ignored. Starting to wait for the opposite presence discards a kept cancellation.
+     *
+     * @param present The card presence awaited by the waits to cancel.
+     */
+    void cancel(const bool present);
+
+    /**
+     * Forgets the last known card presence, to be called before (re)starting the monitoring.
+     */
+    void reset();
+
+    /**
+     * Sets a listener to which the notifications are forwarded once the tracked presence is
+     * updated.
+     *
+     * @param listener The listener, null to stop forwarding.
+     */
+    void setNextListener(std::shared_ptr<CardPresenceListener> listener);
+
+    /**
+     * Sets a function deciding from the ATR whether an inserted card is taken into account.
+     *
+     * <p>The function is called from the monitoring thread. Once this method has returned, the
+     * previous function is no longer being called.
+     *
+     * @param filter The function, returning false to ignore the card, null to accept all cards.
+     */
+    void setInsertionFilter(std::function<bool(const std::vector<uint8_t>&)> filter);
+
+private:
+    /**
+     *
+     */
+    std::mutex mMutex;
+
+    /**
+     *
+     */
+    std::condition_variable mCondition;
+
+    /**
+     * False until the monitor has notified the initial state of the terminal.
+     */
+    bool mIsPresenceKnown;
+
+    /**
+     *
+     */
+    bool mIsCardPresent;
+
+    /**
+     * True from a monitoring failure until the next card presence notification.
+     */
+    bool mIsMonitoringFailed;
+
+    /**
+     *
+     */
+    std::string mMonitoringFailureReason;
+
+    /**
+     *
+     */
+    uint64_t mInsertionCount;
+
+    /**
+     *
+     */
+    uint64_t mRemovalCount;
+
+    /**
+     * State of the waits for one card presence.
+     */
+    struct Waiter {
+        /**
+         *
+         */
+        Waiter();
+
+        /**
+         * Number of threads blocked in waitForCardPresence.
+         */
+        int blockedCount;
+
+        /**
+         * Incremented by each cancellation, releases the blocked threads.
+         */
+        uint64_t cancellationCount;
+
+        /**
+         * True if a cancellation is kept for the next wait.
+         */
+        bool isCancellationPending;
+
+        /**
+         * True if the last wait has reached the presence and no wait started since.
+         */
+        bool isReached;
+    };
+
+    /**
+     * Waits for a card removal (index 0) and for a card insertion (index 1).
+     */
+    Waiter mWaiters[2];
+
+    /**
+     *
+     */
+    std::shared_ptr<CardPresenceListener> mNextListener;
+
+    /**
+     * Guards mInsertionFilter, held during its calls.
+     */
+    std::mutex mInsertionFilterMutex;
+
+    /**
+     *
+     */
+    std::function<bool(const std::vector<uint8_t>&)> mInsertionFilter;
+};
+
+}
+}
+}
+}
@@ -12,6 +12,7 @@
 
 #include "CardTerminal.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstring>
 
@@ -38,6 +39,15 @@ using namespace keyple::plugin::pcsc::cpp::exception;
 
 using DisconnectionMode = PcscReader::DisconnectionMode;
 
+const DWORD CardTerminal::SHORT_RESPONSE_LENGTH = 261;
+const DWORD CardTerminal::EXTENDED_RESPONSE_LENGTH = 65538;
+const size_t CardTerminal::NEGOTIATED_PROTOCOLS_MAX_SIZE = 64;
+
+#if !defined(WIN32) && !defined(SCARD_ATTR_MAXINPUT)
+/* Defined by the pcsc-lite reader.h: maximum APDU length supported by a CCID reader */
+#define SCARD_ATTR_MAXINPUT 0x0007A007
+#endif
+
 #ifdef WIN32
 std::string pcsc_stringify_error(LONG rv)
 {
@@ -49,9 +59,36 @@ std::string pcsc_stringify_error(LONG rv)
 #endif
 
 CardTerminal::CardTerminal(const std::string& name)
-: mContext(0), mHandle(0), mState(0), mName(name), mContextEstablished(false)
+: mContextManager(CardContextManager::getInstance()),
+  mContext(0),
+  mHandle(0),
+  mIsConnected(false),
+  mConnectionProtocol(ConnectionProtocol::ANY),
+  mPreferredProtocols(0),
+  mIsConnectionExclusive(false),
+  mApduPipeline(&CardTerminal::transmitFramed<DirectFraming>),
+  mState(0),
+  mName(name),
+  mMaxResponseLength(SHORT_RESPONSE_LENGTH),
+  mTransactionDepth(0),
+  mShareMode(SCARD_SHARE_SHARED),
+  mIsExclusiveTransaction(false),
+  mApduCount(0),
+  mApduDuration(0)
 {
     memset(&mPioSendPCI, 0, sizeof(SCARD_IO_REQUEST));
+
+    mContextManager->addTerminal(mName);
+}
+
+CardTerminal::~CardTerminal()
+{
+    if (mIsConnected) {
+        disconnect(SCARD_LEAVE_CARD);
+    }
+
+    /* Releases the connection context if this terminal was the last one with this name */
+    mContextManager->removeTerminal(mName);
 }
 
 const std::string& CardTerminal::getName() const
@@ -61,110 +98,70 @@ const std::string& CardTerminal::getName() const
 
 const std::vector<std::string>& CardTerminal::listTerminals()
 {
-    ULONG ret;
-    SCARDCONTEXT context;
-    char* readers = NULL;
-    char* ptr     = NULL;
-    DWORD len     = 0;
     static std::vector<std::string> list;
 
     /* Clear list */
     list.clear();
 
-    ret = SCardEstablishContext(SCARD_SCOPE_USER, NULL, NULL, &context);
-    if (ret != SCARD_S_SUCCESS) {
-        throw CardTerminalException("SCardEstablishContext failed");
-    }
-
-    ret = SCardListReaders(context, NULL, NULL, &len);
-    if (ret != SCARD_S_SUCCESS && ret != SCARD_E_NO_READERS_AVAILABLE) {
-        throw CardTerminalException("SCardListReaders failed");
-    }
+    const std::shared_ptr<CardContextManager> contextManager = CardContextManager::getInstance();
 
-    if (ret == SCARD_E_NO_READERS_AVAILABLE || len == 0) {
-        /* No readers to add to list */
-        return list;
-    }
+    /* A context lost along with the PC/SC service is established again once */
+    for (int attempt = 0; attempt < 2; attempt++) {
+        const SCARDCONTEXT context = contextManager->getContext(CardContextManager::ENUMERATION);
+        DWORD len = 0;
 
-    readers = (char*)calloc(len, sizeof(char));
+        LONG ret = SCardListReaders(context, NULL, NULL, &len);
+        if (ret == SCARD_E_NO_READERS_AVAILABLE || (ret == SCARD_S_SUCCESS && len == 0)) {
+            /* No readers to add to list */
+            return list;
+        }
 
-    if (readers == NULL) {
-        /* No readers to add to list */
-        return list;
-    }
+        std::vector<char> readers;
+        if (ret == SCARD_S_SUCCESS) {
+            readers.resize(len);
+            ret = SCardListReaders(context, NULL, readers.data(), &len);
+            if (ret == SCARD_E_NO_READERS_AVAILABLE) {
+                return list;
+            }
+        }
 
-    ret = SCardListReaders(context, NULL, readers, &len);
-    if (ret != SCARD_S_SUCCESS) {
-        throw CardTerminalException("SCardListReaders failed");
-    }
+        if (ret != SCARD_S_SUCCESS) {
+            if (contextManager->handleError(CardContextManager::ENUMERATION, ret) &&
+                attempt == 0) {
+                continue;
+            }
 
-    ptr = readers;
+            throw CardTerminalException("SCardListReaders failed");
+        }
 
-    if (!ptr) {
-        return list;
-    }
+        for (const char* ptr = readers.data(); *ptr; ptr += strlen(ptr) + 1) {
+            list.push_back(ptr);
+        }
 
-    while (*ptr) {
-        std::string s(ptr);
-        list.push_back(s);
-        ptr += strlen(ptr) + 1;
+        break;
     }
 
-    SCardReleaseContext(context);
-    free(readers);
-
     return list;
 }
 
 void CardTerminal::establishContext()
 {
-    if (mContextEstablished)
-        return;
-
-    LONG ret = SCardEstablishContext(SCARD_SCOPE_USER, NULL, NULL, &mContext);
-    if (ret != SCARD_S_SUCCESS) {
-        mContextEstablished = false;
-        mLogger->error("SCardEstablishContext failed with error: %\n",
-                     std::string(pcsc_stringify_error(ret)));
-        throw CardTerminalException("SCardEstablishContext failed");
-    }
-
-    mContextEstablished = true;
-}
-
-void CardTerminal::releaseContext()
-{
-    if (!mContextEstablished)
-        return;
-
-    SCardReleaseContext(mContext);
-    mContextEstablished = false;
-}
-
-bool CardTerminal::connect()
-{
-    LONG rv = SCardConnect(mContext,
-                           (LPCSTR)mName.c_str(),
-                           SCARD_SHARE_SHARED,
-                           SCARD_PROTOCOL_T0 | SCARD_PROTOCOL_T1,
-                           &mHandle,
-                           &mProtocol);
-
-    return rv == SCARD_S_SUCCESS;
+    mContext = mContextManager->getContext(mName);
 }
 
 const std::vector<uint8_t> CardTerminal::transmitControlCommand(
     const int commandId, const std::vector<uint8_t>& command)
 {
-    char r_apdu[261];
-    DWORD dwRecv = sizeof(r_apdu);
+    /* Some reader features (e.g. escape commands) return large responses */
+    LPBYTE r_apdu = getReceiveBuffer(EXTENDED_RESPONSE_LENGTH);
+    DWORD dwRecv = EXTENDED_RESPONSE_LENGTH;
 
     LONG rv = SCardControl(mHandle,
                           (DWORD)commandId,
                           (LPCBYTE)command.data(),
                           (DWORD)command.size(),
-                          (LPBYTE)r_apdu,
-                          (DWORD)sizeof(r_apdu),
+                          r_apdu,
+                          EXTENDED_RESPONSE_LENGTH,
                           &dwRecv);
     if (rv != SCARD_S_SUCCESS) {
         mLogger->error("SCardControl failed with error: %\n",
@@ -177,14 +174,31 @@ const std::vector<uint8_t> CardTerminal::transmitControlCommand(
     return response;
 }
 
-void CardTerminal::disconnect()
-{
-    SCardDisconnect(mHandle, SCARD_LEAVE_CARD);
-}
-
 bool CardTerminal::isCardPresent(bool release)
 {
     (void)release;
+
+    if (mIsConnected) {
+        DWORD readerLen = 0;
+        DWORD state;
+        DWORD protocol;
+        DWORD atrLen = 0;
+
+        LONG rv = SCardStatus(mHandle, NULL, &readerLen, &state, &protocol, NULL, &atrLen);
+        if (rv == SCARD_S_SUCCESS || rv == SCARD_W_RESET_CARD) {
+            return true;
+        }
+
+        if (rv == SCARD_W_REMOVED_CARD || rv == SCARD_E_NO_SMARTCARD) {
+            return false;
+        }
+
+        /* The handle is unusable, fall back on the reader state */
+        mLogger->debug("[%] isCardPresent - SCardStatus failed (%)\n",
+                       mName,
+                       std::string(pcsc_stringify_error(rv)));
+    }
+
     try {
         establishContext();
     } catch (CardTerminalException& e) {
@@ -192,23 +206,68 @@ bool CardTerminal::isCardPresent(bool release)
         throw;
     }
 
-    bool status = connect();
-    disconnect();
+    SCARD_READERSTATE readerState;
+    memset(&readerState, 0, sizeof(SCARD_READERSTATE));
+    readerState.szReader = mName.c_str();
+    readerState.dwCurrentState = SCARD_STATE_UNAWARE;
 
-    return status;
+    LONG rv = SCardGetStatusChange(mContext, 0, &readerState, 1);
+    if (rv != SCARD_S_SUCCESS) {
+        mLogger->error("[%] isCardPresent - SCardGetStatusChange failed (%)\n",
+                       mName,
+                       std::string(pcsc_stringify_error(rv)));
+        mContextManager->handleError(mName, rv);
+        throw CardTerminalException("isCardPresent failed");
+    }
+
+    const bool isPresent = (readerState.dwEventState & SCARD_STATE_PRESENT) &&
+                           !(readerState.dwEventState & SCARD_STATE_MUTE);
+
+    /* Known before connecting, allows to request the protocol negotiated for this ATR */
+    mPresenceAtr.clear();
+    if (isPresent) {
+        const DWORD atrLength = std::min<DWORD>(readerState.cbAtr, sizeof(readerState.rgbAtr));
+        mPresenceAtr.assign(readerState.rgbAtr, readerState.rgbAtr + atrLength);
+    }
+
+    return isPresent;
+}
+
+bool CardTerminal::getConnectionProtocol(const std::string& protocol,
+                                         ConnectionProtocol& connectionProtocol)
+{
+    if (protocol == "*") {
+        connectionProtocol = ConnectionProtocol::ANY;
+    } else if (protocol == "T=0") {
+        connectionProtocol = ConnectionProtocol::T0;
+    } else if (protocol == "T=1") {
+        connectionProtocol = ConnectionProtocol::T1;
+    } else if (protocol == "direct") {
+        connectionProtocol = ConnectionProtocol::DIRECT;
+    } else {
+        return false;
+    }
+
+    return true;
 }
 
-void CardTerminal::openAndConnect(const std::string& protocol)
+void CardTerminal::openAndConnect(const ConnectionProtocol protocol,
+                                  const bool exclusive,
+                                  const std::vector<uint8_t>& expectedAtr)
 {
     LONG rv;
-    DWORD connectProtocol;
-    DWORD sharingMode = SCARD_SHARE_SHARED;
+    DWORD connectProtocol = 0;
+    DWORD sharingMode = exclusive ? SCARD_SHARE_EXCLUSIVE : SCARD_SHARE_SHARED;
     BYTE reader[200];
     DWORD readerLen = sizeof(reader);
     BYTE _atr[33];
     DWORD atrLen = sizeof(_atr);
 
-    mLogger->debug("[%] openAndConnect - protocol: %\n", mName, protocol);
+    mLogger->debug("[%] openAndConnect - protocol: %\n", mName, static_cast<int>(protocol));
+
+    if (mIsConnected && reuseConnection(protocol, exclusive)) {
+        return;
+    }
 
     try {
         establishContext();
@@ -217,46 +276,65 @@ void CardTerminal::openAndConnect(const std::string& protocol)
         throw;
     }
 
-    if (!protocol.compare("*")) {
+    switch (protocol) {
+    case ConnectionProtocol::ANY:
         connectProtocol = SCARD_PROTOCOL_T0 | SCARD_PROTOCOL_T1;
-    } else if (!protocol.compare("T=0")) {
+        break;
+    case ConnectionProtocol::T0:
         connectProtocol = SCARD_PROTOCOL_T0;
-    } else if (!protocol.compare("T=1")) {
+        break;
+    case ConnectionProtocol::T1:
         connectProtocol = SCARD_PROTOCOL_T1;
-    } else if (!protocol.compare("direct")) {
+        break;
+    case ConnectionProtocol::DIRECT:
         connectProtocol = 0;
         sharingMode     = SCARD_SHARE_DIRECT;
-    } else {
-        throw IllegalArgumentException("Unsupported protocol " + protocol);
+        break;
     }
 
-    mLogger->debug("openAndConnect - connecting tp % with protocol: %, "
-                   "connectProtocol: % and sharingMode: %\n",
+    /* Requests the protocol negotiated the last time for the same ATR */
+    const std::vector<uint8_t>& knownAtr = expectedAtr.empty() ? mPresenceAtr : expectedAtr;
+    auto negotiated = mNegotiatedProtocols.end();
+    if (protocol == ConnectionProtocol::ANY && !knownAtr.empty()) {
+        negotiated = mNegotiatedProtocols.find(knownAtr);
+        if (negotiated != mNegotiatedProtocols.end()) {
+            connectProtocol = negotiated->second.protocol;
+        }
+    }
+
+    mLogger->debug("openAndConnect - connecting tp % with connectProtocol: % and sharingMode: %\n",
                    mName,
-                   protocol,
                    connectProtocol,
                    sharingMode);
 
-    rv = SCardConnect(mContext,
-                      mName.c_str(),
-                      sharingMode,
-                      connectProtocol,
-                      &mHandle,
-                      &mProtocol);
+    rv = connect(sharingMode, connectProtocol);
+    if (rv == SCARD_E_PROTO_MISMATCH && negotiated != mNegotiatedProtocols.end()) {
+        /* Another card with the same ATR, the protocol has to be negotiated again */
+        mLogger->debug("openAndConnect - remembered protocol rejected, negotiating\n");
+        mNegotiatedProtocols.erase(negotiated);
+        negotiated = mNegotiatedProtocols.end();
+        connectProtocol = SCARD_PROTOCOL_T0 | SCARD_PROTOCOL_T1;
+        rv = connect(sharingMode, connectProtocol);
+    }
+
     if (rv != SCARD_S_SUCCESS) {
         mLogger->error("openAndConnect - SCardConnect failed (%)\n",
                        std::string(pcsc_stringify_error(rv)));
-        releaseContext();
+        mContextManager->handleError(mName, rv);
         throw CardTerminalException("openAndConnect failed");
     }
 
-    switch (mProtocol) {
-    case SCARD_PROTOCOL_T0:
-        mPioSendPCI = *SCARD_PCI_T0;
-        break;
-    case SCARD_PROTOCOL_T1:
-        mPioSendPCI = *SCARD_PCI_T1;
-        break;
+    if (negotiated != mNegotiatedProtocols.end()) {
+        mPioSendPCI = *negotiated->second.pci;
+    } else {
+        switch (mProtocol) {
+        case SCARD_PROTOCOL_T0:
+            mPioSendPCI = *SCARD_PCI_T0;
+            break;
+        case SCARD_PROTOCOL_T1:
+            mPioSendPCI = *SCARD_PCI_T1;
+            break;
+        }
     }
 
     rv = SCardStatus(mHandle, (LPSTR)reader, &readerLen, &mState,
@@ -264,23 +342,199 @@ void CardTerminal::openAndConnect(const std::string& protocol)
     if (rv != SCARD_S_SUCCESS) {
         mLogger->error("openAndConnect - SCardStatus failed (s)\n",
                       std::string(pcsc_stringify_error(rv)));
-        releaseContext();
+        SCardDisconnect(mHandle, SCARD_LEAVE_CARD);
+        mContextManager->handleError(mName, rv);
         throw CardTerminalException("openAndConnect failed");
     } else {
         mLogger->debug("openAndConnect - card state: %\n", mState);
     }
 
+    selectApduPipeline();
+
     mAtr.clear();
     mAtr.insert(mAtr.end(), _atr, _atr + atrLen);
+    mParsedAtr = AnswerToReset(mAtr);
+    mLogger->debug("openAndConnect - ATR valid: %, protocols: %, Fi: %, Di: %\n",
+                   mParsedAtr.isValid(),
+                   mParsedAtr.getProtocols(),
+                   mParsedAtr.getFi(),
+                   mParsedAtr.getDi());
+
+    if (protocol == ConnectionProtocol::ANY &&
+        negotiated == mNegotiatedProtocols.end() &&
+        (mProtocol == SCARD_PROTOCOL_T0 || mProtocol == SCARD_PROTOCOL_T1)) {
+        if (mNegotiatedProtocols.size() >= NEGOTIATED_PROTOCOLS_MAX_SIZE) {
+            mNegotiatedProtocols.clear();
+        }
+
+        mNegotiatedProtocols[mAtr] = {mProtocol,
+                                      mProtocol == SCARD_PROTOCOL_T0 ? SCARD_PCI_T0 : SCARD_PCI_T1};
+    }
+
+    mMaxResponseLength = getMaxResponseLength();
+    mLogger->debug("openAndConnect - max response length: %\n", mMaxResponseLength);
+
+    mConnectionProtocol = protocol;
+    mPreferredProtocols = connectProtocol;
+    mIsConnectionExclusive = exclusive;
+    mShareMode = sharingMode;
+    mIsExclusiveTransaction = false;
+    mTransactionDepth = 0;
+    mIsConnected = true;
+
+    startSession(exclusive);
+}
+
+LONG CardTerminal::connect(DWORD& sharingMode, const DWORD connectProtocol)
+{
+    LONG rv = SCardConnect(mContext,
+                           mName.c_str(),
+                           sharingMode,
+                           connectProtocol,
+                           &mHandle,
+                           &mProtocol);
+    if (rv == SCARD_E_SHARING_VIOLATION && sharingMode == SCARD_SHARE_EXCLUSIVE) {
+        /* Another application is connected, the exclusivity will rely on a transaction */
+        mLogger->debug("openAndConnect - card in use, connecting in shared mode\n");
+        sharingMode = SCARD_SHARE_SHARED;
+        rv = SCardConnect(mContext,
+                          mName.c_str(),
+                          sharingMode,
+                          connectProtocol,
+                          &mHandle,
+                          &mProtocol);
+    }
+
+    return rv;
 }
 
-void CardTerminal::closeAndDisconnect(const DisconnectionMode mode)
+bool CardTerminal::reuseConnection(const ConnectionProtocol protocol, const bool exclusive)
 {
-    mLogger->debug("[%] closeAndDisconnect - mode: %\n", mName, mode);
+    if (protocol != mConnectionProtocol || exclusive != mIsConnectionExclusive) {
+        mLogger->debug("[%] openAndConnect - kept connection not suitable, reconnecting\n", mName);
+        disconnect(SCARD_LEAVE_CARD);
+        return false;
+    }
+
+    /* Checks that the card has not been removed or reset by another application meanwhile */
+    LONG rv = readStatus();
+    if (rv != SCARD_S_SUCCESS) {
+        mLogger->debug("[%] openAndConnect - kept connection lost (%), reconnecting\n",
+                       mName,
+                       std::string(pcsc_stringify_error(rv)));
+        disconnect(SCARD_LEAVE_CARD);
+        mContextManager->handleError(mName, rv);
+        return false;
+    }
+
+    mLogger->debug("[%] openAndConnect - reusing the kept connection\n", mName);
+
+    startSession(exclusive);
+
+    return true;
+}
+
+void CardTerminal::startSession(const bool exclusive)
+{
+    mApduCount = 0;
+    mApduDuration = 0;
+
+    if (exclusive && mShareMode == SCARD_SHARE_SHARED) {
+        try {
+            beginExclusive();
+        } catch (const CardTerminalException& e) {
+            (void)e;
+            disconnect(SCARD_LEAVE_CARD);
+            throw;
+        }
+    }
+}
 
-    SCardDisconnect(mHandle, mode == DisconnectionMode::RESET ? SCARD_RESET_CARD : SCARD_LEAVE_CARD);
+void CardTerminal::disconnect(const DWORD disposition)
+{
+    /* Disconnecting ends the transaction, if any */
+    mIsConnected = false;
+    mIsExclusiveTransaction = false;
+    mTransactionDepth = 0;
 
-    releaseContext();
+    SCardDisconnect(mHandle, disposition);
+}
+
+void CardTerminal::closeAndDisconnect(const DisconnectionMode mode, const bool keepConnection)
+{
+    if (!mIsConnected) {
+        return;
+    }
+
+    mLogger->debug("[%] closeAndDisconnect - mode: %, % APDU(s) exchanged in % us (%)\n",
+                   mName,
+                   mode,
+                   mApduCount,
+                   mApduDuration,
+                   mShareMode == SCARD_SHARE_EXCLUSIVE || mIsExclusiveTransaction ?
+                       "exclusive" : "shared");
+
+    if (!keepConnection) {
+        disconnect(mode == DisconnectionMode::RESET ? SCARD_RESET_CARD : SCARD_LEAVE_CARD);
+        return;
+    }
+
+    /* Shares the card again until the next session, the connection stays alive */
+    if (mIsExclusiveTransaction) {
+        mIsExclusiveTransaction = false;
+        endTransaction();
+    }
+
+    if (mode == DisconnectionMode::RESET) {
+        /* mProtocol is updated by readStatus, which detects the change */
+        DWORD protocol = 0;
+        LONG rv = SCardReconnect(mHandle,
+                                 mShareMode,
+                                 mPreferredProtocols,
+                                 SCARD_RESET_CARD,
+                                 &protocol);
+        if (rv != SCARD_S_SUCCESS) {
+            /* The next session will connect again */
+            mLogger->debug("[%] closeAndDisconnect - SCardReconnect failed (%)\n",
+                           mName,
+                           std::string(pcsc_stringify_error(rv)));
+            disconnect(SCARD_LEAVE_CARD);
+            return;
+        }
+
+        /* The reset may have renegotiated the protocol and changed the ATR */
+        rv = readStatus();
+        if (rv != SCARD_S_SUCCESS) {
+            mLogger->debug("[%] closeAndDisconnect - SCardStatus failed (%)\n",
+                           mName,
+                           std::string(pcsc_stringify_error(rv)));
+            disconnect(SCARD_LEAVE_CARD);
+        }
+    }
+}
+
+LONG CardTerminal::readStatus()
+{
+    BYTE _atr[33];
+    DWORD atrLen = sizeof(_atr);
+    DWORD readerLen = 0;
+    const DWORD previousProtocol = mProtocol;
+
+    LONG rv = SCardStatus(mHandle, NULL, &readerLen, &mState, &mProtocol, _atr, &atrLen);
+    if (rv != SCARD_S_SUCCESS) {
+        return rv;
+    }
+
+    selectApduPipeline();
+
+    if (mProtocol != previousProtocol) {
+        mMaxResponseLength = getMaxResponseLength();
+    }
+
+    mAtr.assign(_atr, _atr + atrLen);
+    mParsedAtr = AnswerToReset(mAtr);
+
+    return rv;
 }
 
 const std::vector<uint8_t>& CardTerminal::getATR()
@@ -288,155 +542,327 @@ const std::vector<uint8_t>& CardTerminal::getATR()
     return mAtr;
 }
 
+const AnswerToReset& CardTerminal::getParsedAtr() const
+{
+    return mParsedAtr;
+}
+
 std::vector<uint8_t> CardTerminal::transmitApdu(const std::vector<uint8_t>& apduIn)
 {
-    if (apduIn.size() == 0)
-        throw IllegalArgumentException("command cannot be empty");
+    std::vector<uint8_t> result;
+    transmitApdu(apduIn.data(), apduIn.size(), result);
 
-    /* Make a copy */
-    std::vector<uint8_t> _apduIn = apduIn;
+    return result;
+}
+
+void CardTerminal::transmitApdu(const uint8_t* apduIn,
+                                const size_t apduInLength,
+                                std::vector<uint8_t>& apduOut)
+{
+    const auto start = std::chrono::steady_clock::now();
 
-    /* To check */
-    bool t0GetResponse = true;
-    bool t1GetResponse = true;
-    bool t1StripLe     = true;
+    apduOut.clear();
 
     /*
-     * Note that we modify the 'command' array in some cases, so it must be a copy of the
-     * application provided data
+     * Not wrapped in a transaction: it would cost two more round trips to the PC/SC service for
+     * each APDU, the exchanges needing it are grouped with transmitApdus or beginExclusive
      */
-    int n   = static_cast<int>(_apduIn.size());
-    bool t0 = mProtocol == SCARD_PROTOCOL_T0;
-    bool t1 = mProtocol == SCARD_PROTOCOL_T1;
+    appendApduResponse(apduIn, apduInLength, apduOut);
 
-    if (t0 && (n >= 7) && (_apduIn[4] == 0))
-        throw CardTerminalException("Extended len. not supported for T=0");
+    recordOperation(1, start);
+}
 
-    if ((t0 || (t1 && t1StripLe)) && (n >= 7)) {
-        int lc = _apduIn[4] & 0xff;
-        if (lc != 0) {
-            if (n == lc + 6) {
-                n--;
-            }
-        } else {
-            lc = ((_apduIn[5] & 0xff) << 8) | (_apduIn[6] & 0xff);
-            if (n == lc + 9) {
-                n -= 2;
+void CardTerminal::transmitApdus(const std::vector<BatchApdu>& apdus,
+                                 BatchResponse& batchResponse)
+{
+    batchResponse.responses.clear();
+    batchResponse.responseEnds.clear();
+    batchResponse.isComplete = false;
+
+    mLogger->debug("[%] transmitApdus - % command(s)\n", mName, apdus.size());
+
+    const auto startTime = std::chrono::steady_clock::now();
+
+    beginOperation();
+
+    try {
+        for (const auto& apdu : apdus) {
+            appendApduResponse(apdu.command.data(), apdu.command.size(), batchResponse.responses);
+
+            const std::vector<uint8_t>& responses = batchResponse.responses;
+            const size_t end = responses.size();
+            const size_t start = batchResponse.responseEnds.empty() ?
+                                     0 : batchResponse.responseEnds.back();
+            batchResponse.responseEnds.push_back(end);
+
+            if (apdu.statusWordMask != 0) {
+                const uint16_t sw = end - start >= 2 ?
+                                        static_cast<uint16_t>((responses[end - 2] << 8) |
+                                                              responses[end - 1]) :
+                                        0;
+                if ((sw & apdu.statusWordMask) !=
+                    (apdu.expectedStatusWord & apdu.statusWordMask)) {
+                    mLogger->debug("[%] transmitApdus - unexpected status word, % of % command(s)" \
+                                   " transmitted\n",
+                                   mName,
+                                   batchResponse.responseEnds.size(),
+                                   apdus.size());
+                    endOperation();
+                    recordOperation(batchResponse.responseEnds.size(), startTime);
+                    return;
+                }
             }
         }
+    } catch (...) {
+        endOperation();
+        throw;
+    }
+
+    endOperation();
+    recordOperation(batchResponse.responseEnds.size(), startTime);
+
+    batchResponse.isComplete = true;
+}
+
+void CardTerminal::beginTransaction()
+{
+    if (mTransactionDepth++ > 0) {
+        return;
+    }
+
+    LONG rv = SCardBeginTransaction(mHandle);
+    if (rv != SCARD_S_SUCCESS) {
+        mTransactionDepth--;
+        mLogger->error("SCardBeginTransaction failed with error: %\n",
+                       std::string(pcsc_stringify_error(rv)));
+        throw CardTerminalException("SCardBeginTransaction failed");
+    }
+}
+
+void CardTerminal::endTransaction()
+{
+    if (mTransactionDepth == 0 || --mTransactionDepth > 0) {
+        return;
+    }
+
+    LONG rv = SCardEndTransaction(mHandle, SCARD_LEAVE_CARD);
+    if (rv != SCARD_S_SUCCESS) {
+        /* The card may have been removed meanwhile, nothing else to release */
+        mLogger->debug("[%] SCardEndTransaction failed (%)\n",
+                       mName,
+                       std::string(pcsc_stringify_error(rv)));
     }
+}
+
+void CardTerminal::appendApduResponse(const uint8_t* apduIn,
+                                      const size_t apduInLength,
+                                      std::vector<uint8_t>& apduOut)
+{
+    if (apduIn == nullptr || apduInLength == 0)
+        throw IllegalArgumentException("command cannot be empty");
+
+    (this->*mApduPipeline)(apduIn, apduInLength, apduOut);
+}
+
+void CardTerminal::selectApduPipeline()
+{
+    switch (mProtocol) {
+    case SCARD_PROTOCOL_T0:
+        mApduPipeline = &CardTerminal::transmitFramed<T0Framing>;
+        mPioSendPCI = *SCARD_PCI_T0;
+        break;
+    case SCARD_PROTOCOL_T1:
+        mApduPipeline = &CardTerminal::transmitFramed<T1Framing>;
+        mPioSendPCI = *SCARD_PCI_T1;
+        break;
+    default:
+        mApduPipeline = &CardTerminal::transmitFramed<DirectFraming>;
+        break;
+    }
+}
+
+/* Length of a command without its Le field (case 4 commands), used to rewrite Le on 6Cxx */
+static size_t getLengthWithoutLe(const std::vector<uint8_t>& command)
+{
+    const size_t n = command.size();
+    if (n < 7) {
+        return n;
+    }
+
+    const size_t lc = command[4];
+    if (lc != 0) {
+        return n == lc + 6 ? n - 1 : n;
+    }
+
+    const size_t extendedLc = (static_cast<size_t>(command[5]) << 8) | command[6];
+
+    return n == extendedLc + 9 ? n - 2 : n;
+}
+
+template <typename Framing>
+void CardTerminal::transmitFramed(const uint8_t* apduIn,
+                                  const size_t apduInLength,
+                                  std::vector<uint8_t>& apduOut)
+{
+    if (Framing::REJECTS_EXTENDED_LENGTH && apduInLength >= 7 && apduIn[4] == 0)
+        throw CardTerminalException("Extended len. not supported for T=0");
+
+    /*
+     * Make a copy (without allocation once mCommand has grown), the command is modified in some
+     * cases
+     */
+    mCommand.assign(apduIn, apduIn + apduInLength);
 
-    bool getresponse = (t0 && t0GetResponse) || (t1 && t1GetResponse);
     int k = 0;
-    std::vector<uint8_t> result;
+
+    /* Length of the data already in the buffer (previous responses and 61xx chaining) */
+    size_t offset = apduOut.size();
+    const size_t start = offset;
 
     while (true) {
         if (++k >= 32) {
             throw CardTerminalException("Could not obtain response");
         }
 
-        char r_apdu[261];
-        DWORD dwRecv = sizeof(r_apdu);
+        /*
+         * Received in the member buffer: growing apduOut to the maximum response length would
+         * zero-fill up to 64 KB per exchange, and leave that capacity to the returned responses
+         */
+        LPBYTE r_apdu = getReceiveBuffer(mMaxResponseLength);
+        DWORD dwRecv = mMaxResponseLength;
         long rv;
 
-        mLogger->debug("[%] transmitApdu - c-apdu >> %\n", mName, _apduIn);
+        mLogger->debug("[%] transmitApdu - c-apdu >> %\n", mName, mCommand);
 
         rv = SCardTransmit(mHandle,
                            &mPioSendPCI,
-                           (LPCBYTE)_apduIn.data(),
-                           static_cast<DWORD>(_apduIn.size()),
+                           (LPCBYTE)mCommand.data(),
+                           static_cast<DWORD>(mCommand.size()),
                            NULL,
-                           (LPBYTE)r_apdu,
+                           r_apdu,
                            &dwRecv);
         if (rv != SCARD_S_SUCCESS) {
+            apduOut.resize(start);
             mLogger->error("SCardTransmit failed with error: %\n",
                            std::string(pcsc_stringify_error(rv)));
             throw CardTerminalException("ScardTransmit failed");
         }
 
-        std::vector<uint8_t> response(r_apdu, r_apdu + dwRecv);
+        /* Appends after the data already received, overwriting the previous status word */
+        apduOut.resize(offset);
+        apduOut.insert(apduOut.end(), r_apdu, r_apdu + dwRecv);
 
-        mLogger->debug("[%] transmitApdu - r-apdu << %\n", mName, response);
+        mLogger->debug("[%] transmitApdu - r-apdu << %\n", mName, apduOut);
 
-        int rn = static_cast<int>(response.size());
-        if (getresponse && (rn >= 2)) {
-            /* See ISO 7816/2005, 5.1.3 */
-            if ((rn == 2) && (response[0] == 0x6c)) {
-                // Resend command using SW2 as short Le field
-                _apduIn[n - 1] = response[1];
-                continue;
-            }
+        if (!Framing::HANDLES_STATUS_WORDS || dwRecv < 2) {
+            break;
+        }
 
-            if (response[rn - 2] == 0x61) {
-                /* Issue a GET RESPONSE command with the same CLA using SW2 as short Le field */
-                if (rn > 2)
-                    result.insert(result.end(), response.begin(), response.begin() + rn - 2);
-
-                std::vector<uint8_t> getResponse(5);
-                getResponse[0] = _apduIn[0];
-                getResponse[1] = 0xC0;
-                getResponse[2] = 0;
-                getResponse[3] = 0;
-                getResponse[4] = response[rn - 1];
-                n          = 5;
-                _apduIn.swap(getResponse);
-                continue;
-            }
+        /* See ISO 7816/2005, 5.1.3 */
+        const uint8_t* response = apduOut.data() + offset;
+        if (dwRecv == 2 && response[0] == 0x6c) {
+            /* Resend command using SW2 as short Le field */
+            mCommand[getLengthWithoutLe(mCommand) - 1] = response[1];
+            continue;
+        }
+
+        if (response[dwRecv - 2] == 0x61) {
+            /* Issue a GET RESPONSE command with the same CLA using SW2 as short Le field */
+            const uint8_t getResponse[5] = {mCommand[0], 0xC0, 0, 0, response[dwRecv - 1]};
+            mCommand.assign(getResponse, getResponse + 5);
+
+            /* Keep the data, the status word is overwritten by the next response */
+            offset += dwRecv - 2;
+            continue;
         }
 
-        result.insert(result.end(), response.begin(), response.begin() + rn);
         break;
     }
+}
 
-    return result;
+DWORD CardTerminal::getMaxResponseLength() const
+{
+    if (mProtocol != SCARD_PROTOCOL_T1) {
+        return SHORT_RESPONSE_LENGTH;
+    }
+
+#ifdef SCARD_ATTR_MAXINPUT
+    uint32_t maxInput = 0;
+    DWORD len = sizeof(maxInput);
+
+    LONG rv = SCardGetAttrib(mHandle, SCARD_ATTR_MAXINPUT, (LPBYTE)&maxInput, &len);
+    if (rv == SCARD_S_SUCCESS && len == sizeof(maxInput)) {
+        return std::max(SHORT_RESPONSE_LENGTH,
+                        std::min(EXTENDED_RESPONSE_LENGTH, static_cast<DWORD>(maxInput)));
+    }
+#endif
+
+    return EXTENDED_RESPONSE_LENGTH;
 }
 
-void CardTerminal::beginExclusive()
+LPBYTE CardTerminal::getReceiveBuffer(const DWORD length)
 {
+    if (mReceiveBuffer.size() < length) {
+        mReceiveBuffer.resize(length);
+    }
+
+    return mReceiveBuffer.data();
 }
 
-void CardTerminal::endExclusive()
+void CardTerminal::beginExclusive()
 {
+    if (mShareMode != SCARD_SHARE_SHARED || mIsExclusiveTransaction) {
+        return;
+    }
+
+    beginTransaction();
+    mIsExclusiveTransaction = true;
 }
 
-bool CardTerminal::waitForCardAbsent(long timeout)
+void CardTerminal::endExclusive()
 {
-    uint64_t newMs = 0;
-    uint64_t currentMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-                         std::chrono::system_clock::now().time_since_epoch()).count();
+    if (mIsExclusiveTransaction) {
+        mIsExclusiveTransaction = false;
+        endTransaction();
+        return;
+    }
 
-    do {
-        bool isCardAbsent = !this->isCardPresent(false);
-        if (isCardAbsent) {
-            return true;
-        }
+    if (mShareMode != SCARD_SHARE_EXCLUSIVE) {
+        return;
+    }
 
-        newMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-                     std::chrono::system_clock::now().time_since_epoch()).count();
+    LONG rv = SCardReconnect(mHandle, SCARD_SHARE_SHARED, mProtocol, SCARD_LEAVE_CARD, &mProtocol);
+    if (rv != SCARD_S_SUCCESS) {
+        mLogger->error("SCardReconnect failed with error: %\n",
+                       std::string(pcsc_stringify_error(rv)));
+        throw CardTerminalException("endExclusive failed");
+    }
 
-    } while (newMs <= (currentMs + timeout));
+    selectApduPipeline();
 
-    return false;
+    mShareMode = SCARD_SHARE_SHARED;
 }
 
-bool CardTerminal::waitForCardPresent(long timeout)
+void CardTerminal::beginOperation()
 {
-    uint64_t newMs = 0;
-    uint64_t currentMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-                         std::chrono::system_clock::now().time_since_epoch()).count();
-
-    do {
-        bool isCardPresent = this->isCardPresent(false);
-        if (isCardPresent) {
-            return true;
-        }
-
-        newMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-                     std::chrono::system_clock::now().time_since_epoch()).count();
+    if (mShareMode == SCARD_SHARE_SHARED) {
+        beginTransaction();
+    }
+}
 
-    } while (newMs <= (currentMs + timeout));
+void CardTerminal::endOperation()
+{
+    if (mShareMode == SCARD_SHARE_SHARED) {
+        endTransaction();
+    }
+}
 
-    return false;
+void CardTerminal::recordOperation(const uint64_t apduCount,
+                                   const std::chrono::steady_clock::time_point& start)
+{
+    mApduCount += apduCount;
+    mApduDuration += std::chrono::duration_cast<std::chrono::microseconds>(
+                         std::chrono::steady_clock::now() - start).count();
 }
 
 bool CardTerminal::operator==(const CardTerminal& o) const
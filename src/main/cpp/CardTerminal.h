@@ -12,10 +12,15 @@
 
 #pragma once
 
+#include <chrono>
+#include <map>
+
 /* Keyple Core Util */
 #include "LoggerFactory.h"
 
 /* Keyple Plugin Pcsc */
+#include "AnswerToReset.h"
+#include "CardContextManager.h"
 #include "KeyplePluginPcscExport.h"
 #include "PcscReader.h"
 
@@ -34,19 +39,45 @@ namespace cpp {
 
 using namespace keyple::core::util::cpp;
 
+using BatchApdu = PcscReader::BatchApdu;
+using BatchResponse = PcscReader::BatchResponse;
 using DisconnectionMode = PcscReader::DisconnectionMode;
 
 class KEYPLEPLUGINPCSC_API CardTerminal {
 public:
+    /**
+     * Protocols that can be requested by openAndConnect.
+     */
+    enum class ConnectionProtocol {
+        /* T=0 or T=1, negotiated by the PC/SC service */
+        ANY,
+        /* T=0 */
+        T0,
+        /* T=1 */
+        T1,
+        /* Direct access to the reader, no card needed */
+        DIRECT
+    };
+
     /**
      *
      */
     explicit CardTerminal(const std::string& name);
 
     /**
+     * Gets the connection protocol designated by a protocol name.
      *
+     * @param protocol The protocol name ("*", "T=0", "T=1" or "direct").
+     * @param connectionProtocol Set to the matching connection protocol.
+     * @return False if the protocol is not supported.
      */
-    virtual ~CardTerminal() = default;
+    static bool getConnectionProtocol(const std::string& protocol,
+                                      ConnectionProtocol& connectionProtocol);
+
+    /**
+     *
+     */
+    virtual ~CardTerminal();
 
     /**
      *
@@ -54,22 +85,59 @@ public:
     const std::string& getName() const;
 
     /**
+     * Checks the card presence without connecting to the card.
+     *
+     * <p>While a channel is open, the presence is answered by SCardStatus on the current handle.
+     * Otherwise the current reader state is read with a non-blocking SCardGetStatusChange.
      *
+     * @param release Unused.
+     * @return True if a card is present.
+     * @throw CardTerminalException If the reader state could not be retrieved.
      */
     bool isCardPresent(bool release);
 
     /**
+     * Connects to the card.
      *
+     * <p>An exclusive connection is requested with SCARD_SHARE_EXCLUSIVE. If another application
+     * is connected to the card, the connection is shared and the exclusivity is obtained with a
+     * transaction held until endExclusive or closeAndDisconnect.
+     *
+     * <p>If the connection of the previous session has been kept (see closeAndDisconnect) with the
+     * same protocol and sharing mode, it is reused after a check of the card status.
+     *
+     * <p>When any protocol is accepted, the protocol negotiated for an ATR is remembered and
+     * requested alone on the next connections to a card with the same ATR, the ATR being known
+     * before connecting from the card presence notification or from isCardPresent.
+     *
+     * @param protocol The protocol.
+     * @param exclusive True to get an exclusive access to the card.
+     * @param expectedAtr The ATR of the card present in the terminal, if known.
+     * @throw CardTerminalException If the connection failed.
      */
-    void openAndConnect(const std::string& protocol);
+    void openAndConnect(const ConnectionProtocol protocol,
+                        const bool exclusive,
+                        const std::vector<uint8_t>& expectedAtr = std::vector<uint8_t>());
 
     /**
+     * Ends the card session.
      *
+     * <p>When the connection is kept, the exclusivity obtained with a transaction is released but
+     * the card stays connected: RESET resets the card with SCardReconnect, LEAVE keeps it as is.
+     * Otherwise, the card is disconnected.
+     *
+     * @param mode The action to be taken on the card.
+     * @param keepConnection True to keep the connection alive for the next session.
      */
-    void closeAndDisconnect(const DisconnectionMode mode);
+    void closeAndDisconnect(const DisconnectionMode mode, const bool keepConnection);
 
     /**
+     * Lists the readers known by the PC/SC service.
+     *
+     * <p>Relies on the enumeration context kept by the CardContextManager.
      *
+     * @return The reader names.
+     * @throw CardTerminalException If the readers could not be listed.
      */
     static const std::vector<std::string>& listTerminals();
 
@@ -78,6 +146,13 @@ public:
      */
     const std::vector<uint8_t>& getATR();
 
+    /**
+     * Gets the fields of the ATR of the connected card, decoded at connection time.
+     *
+     * @return The decoded ATR, invalid if the ATR is malformed.
+     */
+    const AnswerToReset& getParsedAtr() const;
+
     /**
      *
      */
@@ -90,24 +165,52 @@ public:
     std::vector<uint8_t> transmitApdu(const std::vector<uint8_t>& apduIn);
 
     /**
+     * Transmits an APDU, receiving the response directly into the provided buffer.
      *
+     * <p>The response buffer is resized to the length of the response, its capacity is reused.
+     * Once the buffer has grown to the size of the largest response, the exchange performs no
+     * heap allocation.
+     *
+     * @param apduIn The command.
+     * @param apduInLength The length of the command.
+     * @param apduOut The buffer receiving the response (data and status word).
+     * @throw IllegalArgumentException If the command is empty.
+     * @throw CardTerminalException If the exchange failed.
      */
-    void beginExclusive();
+    void transmitApdu(const uint8_t* apduIn,
+                      const size_t apduInLength,
+                      std::vector<uint8_t>& apduOut);
 
     /**
+     * Transmits a batch of APDUs within a single PC/SC transaction, stopping at the first
+     * unexpected status word.
      *
+     * @param apdus The commands.
+     * @param batchResponse The object receiving the responses.
+     * @throw IllegalArgumentException If a command is empty.
+     * @throw CardTerminalException If the transaction could not be started or an exchange failed.
      */
-    void endExclusive();
+    void transmitApdus(const std::vector<BatchApdu>& apdus, BatchResponse& batchResponse);
 
     /**
+     * Gets an exclusive access to the card by starting a transaction held until endExclusive or
+     * closeAndDisconnect.
      *
+     * <p>Does nothing if the access is already exclusive.
+     *
+     * @throw CardTerminalException If the transaction could not be started.
      */
-    bool waitForCardAbsent(long timeout);
+    void beginExclusive();
 
     /**
+     * Shares the card again with the other applications.
      *
+     * <p>Ends the transaction started by beginExclusive, or reconnects an exclusive connection in
+     * shared mode (keeping the card state).
+     *
+     * @throw CardTerminalException If the connection could not be shared.
      */
-    bool waitForCardPresent(long timeout);
+    void endExclusive();
 
 	/**
 	 *
@@ -137,7 +240,12 @@ private:
         LoggerFactory::getLogger(typeid(CardTerminal));
 
     /**
-     *
+     * Keeps the connection context alive between the card sessions.
+     */
+    const std::shared_ptr<CardContextManager> mContextManager;
+
+    /**
+     * Connection context, owned by mContextManager.
      */
     SCARDCONTEXT mContext;
 
@@ -151,11 +259,88 @@ private:
      */
     DWORD mProtocol;
 
+    /**
+     * True while mHandle is connected to the card.
+     */
+    bool mIsConnected;
+
+    /**
+     * Protocol requested by openAndConnect for the current connection.
+     */
+    ConnectionProtocol mConnectionProtocol;
+
+    /**
+     * Protocol negotiated for a connection accepting any protocol.
+     */
+    struct NegotiatedProtocol {
+        DWORD protocol;
+        const SCARD_IO_REQUEST* pci;
+    };
+
+    /**
+     * Maximum number of ATRs whose negotiated protocol is remembered.
+     */
+    static const size_t NEGOTIATED_PROTOCOLS_MAX_SIZE;
+
+    /**
+     * Protocols negotiated by the previous connections, by ATR.
+     */
+    std::map<std::vector<uint8_t>, NegotiatedProtocol> mNegotiatedProtocols;
+
+    /**
+     * ATR reported by the last isCardPresent call while disconnected, empty if no card.
+     */
+    std::vector<uint8_t> mPresenceAtr;
+
+    /**
+     * Protocols requested to SCardConnect for the current connection (SCARD_PROTOCOL_xxx).
+     */
+    DWORD mPreferredProtocols;
+
+    /**
+     * Exclusivity requested by openAndConnect for the current connection.
+     */
+    bool mIsConnectionExclusive;
+
     /**
      *
      */
     SCARD_IO_REQUEST mPioSendPCI;
 
+    /**
+     * Framing rules of the T=0 protocol: no extended length, ISO 7816 response handling.
+     */
+    struct T0Framing {
+        static const bool REJECTS_EXTENDED_LENGTH = true;
+        static const bool HANDLES_STATUS_WORDS = true;
+    };
+
+    /**
+     * Framing rules of the T=1 protocol: ISO 7816 response handling.
+     */
+    struct T1Framing {
+        static const bool REJECTS_EXTENDED_LENGTH = false;
+        static const bool HANDLES_STATUS_WORDS = true;
+    };
+
+    /**
+     * Framing rules of the direct and other protocols: the command is transmitted as is.
+     */
+    struct DirectFraming {
+        static const bool REJECTS_EXTENDED_LENGTH = false;
+        static const bool HANDLES_STATUS_WORDS = false;
+    };
+
+    /**
+     * Transmit pipeline specialised for the protocol of the connection.
+     */
+    typedef void (CardTerminal::*ApduPipeline)(const uint8_t*, const size_t, std::vector<uint8_t>&);
+
+    /**
+     * Pipeline of the current connection, selected by selectApduPipeline once mProtocol is known.
+     */
+    ApduPipeline mApduPipeline;
+
     /**
      *
      */
@@ -174,27 +359,163 @@ private:
     /**
      *
      */
-    bool mContextEstablished;
+    AnswerToReset mParsedAtr;
 
     /**
+     * Command being transmitted, may be altered by the ISO 7816 response handling (6Cxx, 61xx).
+     * Kept between calls to reuse its capacity.
+     */
+    std::vector<uint8_t> mCommand;
+
+    /**
+     * Receive buffer shared by transmitApdu and transmitControlCommand, allocated once. Only the
+     * received bytes are copied to the caller's buffer.
+     */
+    std::vector<uint8_t> mReceiveBuffer;
+
+    /**
+     * Maximum length of the response to a single SCardTransmit call on the current connection.
+     */
+    DWORD mMaxResponseLength;
+
+    /**
+     * Length of the largest short APDU response, with some margin for the readers appending data.
+     */
+    static const DWORD SHORT_RESPONSE_LENGTH;
+
+    /**
+     * Length of the largest extended APDU response (65536 bytes of data and the status word).
+     */
+    static const DWORD EXTENDED_RESPONSE_LENGTH;
+
+    /**
+     * Gets the maximum response length supported by the current connection.
      *
+     * <p>Extended responses are only possible with T=1, bounded by the APDU buffer of the reader
+     * when the driver reports it.
      */
-    void establishContext();
+    DWORD getMaxResponseLength() const;
+
+    /**
+     * Gets the receive buffer, grown to at least the provided length.
+     */
+    LPBYTE getReceiveBuffer(const DWORD length);
+
+    /**
+     * Number of nested beginTransaction calls not yet ended.
+     */
+    int mTransactionDepth;
+
+    /**
+     * Sharing mode of the current connection (SCARD_SHARE_xxx).
+     */
+    DWORD mShareMode;
+
+    /**
+     * True while a transaction is held by beginExclusive.
+     */
+    bool mIsExclusiveTransaction;
+
+    /**
+     * Number of APDUs exchanged since the connection, for the statistics logged at disconnection.
+     */
+    uint64_t mApduCount;
+
+    /**
+     * Time spent exchanging APDUs since the connection (in microseconds).
+     */
+    uint64_t mApduDuration;
+
+    /**
+     * Starts a transaction if the card is shared with other applications, so that the exchanges
+     * of a batch are not interleaved with theirs.
+     */
+    void beginOperation();
+
+    /**
+     * Ends the transaction started by beginOperation, if any.
+     */
+    void endOperation();
 
     /**
+     * Reuses the connection kept by the previous session, if it matches the requested one and the
+     * card is still there. Otherwise disconnects it.
      *
+     * @return True if the connection has been reused.
      */
-    void releaseContext();
+    bool reuseConnection(const ConnectionProtocol protocol, const bool exclusive);
 
     /**
+     * Connects to the card with the provided protocols. If the exclusivity is requested and
+     * another application is connected, falls back on a shared connection.
      *
+     * @param sharingMode The sharing mode, updated if the fallback occurred.
+     * @return The SCardConnect result.
+     */
+    LONG connect(DWORD& sharingMode, const DWORD connectProtocol);
+
+    /**
+     * Starts a new session on the current connection.
+     */
+    void startSession(const bool exclusive);
+
+    /**
+     * Disconnects the card.
+     */
+    void disconnect(const DWORD disposition);
+
+    /**
+     * Adds an operation to the statistics of the connection.
+     */
+    void recordOperation(const uint64_t apduCount,
+                         const std::chrono::steady_clock::time_point& start);
+
+    /**
+     * Starts a PC/SC transaction (SCardBeginTransaction), unless one is already started.
      */
-    bool connect();
+    void beginTransaction();
 
     /**
+     * Ends the transaction started by the matching beginTransaction call, the card is left as
+     * is.
+     */
+    void endTransaction();
+
+    /**
+     * Transmits an APDU and appends its response to the provided buffer.
+     */
+    void appendApduResponse(const uint8_t* apduIn,
+                            const size_t apduInLength,
+                            std::vector<uint8_t>& apduOut);
+
+    /**
+     * Transmits an APDU with the framing rules of a protocol (see T0Framing, T1Framing and
+     * DirectFraming), the response being appended to the provided buffer.
+     */
+    template <typename Framing>
+    void transmitFramed(const uint8_t* apduIn,
+                        const size_t apduInLength,
+                        std::vector<uint8_t>& apduOut);
+
+    /**
+     * Selects the transmit pipeline and the send PCI matching mProtocol, to be called each time
+     * it changes.
+     */
+    void selectApduPipeline();
+
+    /**
+     * Reads the state, the protocol and the ATR of the connected card (SCardStatus), then
+     * selects the matching transmit pipeline and maximum response length.
      *
+     * @return The SCardStatus result, the ATR being unchanged on failure.
+     */
+    LONG readStatus();
+
+    /**
+     * Gets the connection context of this reader from the context manager.
      */
-    void disconnect();
+    void establishContext();
+
 };
 
 }
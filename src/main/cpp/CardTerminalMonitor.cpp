@@ -0,0 +1,665 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include "CardTerminalMonitor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <utility>
+
+namespace keyple {
+namespace plugin {
+namespace pcsc {
+namespace cpp {
+
+#ifdef WIN32
+std::string pcsc_stringify_error(LONG rv);
+#endif
+
+#if defined(WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
+const size_t CardTerminalMonitor::MAX_READERS_PER_CALL = MAXIMUM_SMARTCARD_READERS;
+#elif defined(PCSCLITE_MAX_READERS_CONTEXTS)
+const size_t CardTerminalMonitor::MAX_READERS_PER_CALL = PCSCLITE_MAX_READERS_CONTEXTS;
+#else
+const size_t CardTerminalMonitor::MAX_READERS_PER_CALL = 16;
+#endif
+
+const long CardTerminalMonitor::RETRY_DELAY = 1000;
+const long CardTerminalMonitor::CANCEL_RETRY_DELAY = 10;
+const std::string CardTerminalMonitor::PNP_NOTIFICATION = "\\\\?PnP?\\Notification";
+const long CardTerminalMonitor::TERMINAL_LIST_POLLING_PERIOD = 1000;
+
+CardTerminalMonitor::CardTerminalMonitor()
+: mIsRunning(true),
+  mIsTerminalListMonitored(false),
+  mPnpCurrentState(SCARD_STATE_UNAWARE),
+  mIsPnpSupported(true) {}
+
+CardTerminalMonitor::~CardTerminalMonitor()
+{
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+
+        mIsRunning = false;
+        mCondition.notify_all();
+
+        for (const auto& shard : mShards) {
+            while (!shard->isStopped) {
+                if (shard->isContextEstablished) {
+                    SCardCancel(shard->context);
+                }
+
+                mCondition.wait_for(lock, std::chrono::milliseconds(CANCEL_RETRY_DELAY));
+            }
+        }
+    }
+
+    for (const auto& shard : mShards) {
+        if (shard->thread.joinable()) {
+            shard->thread.join();
+        }
+    }
+}
+
+void CardTerminalMonitor::addTerminal(const std::string& name,
+                                      std::shared_ptr<CardPresenceListener> listener)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    mLogger->trace("start monitoring terminal %\n", name);
+
+    /* Already monitored: replace the listener and notify it of the current state again */
+    for (const auto& shard : mShards) {
+        for (auto& entry : shard->entries) {
+            if (entry.name == name) {
+                entry.listener = listener;
+                entry.currentState = SCARD_STATE_UNAWARE;
+                entry.isPresenceKnown = false;
+                entry.isListed = true;
+                wakeUp(shard.get(), lock);
+                return;
+            }
+        }
+    }
+
+    Shard* target = nullptr;
+    for (const auto& shard : mShards) {
+        if (shard->entries.size() < getCapacity(shard.get())) {
+            target = shard.get();
+            break;
+        }
+    }
+
+    if (target == nullptr) {
+        target = createShard();
+    }
+
+    Entry entry;
+    entry.name = name;
+    entry.listener = listener;
+    entry.currentState = SCARD_STATE_UNAWARE;
+    entry.isPresenceKnown = false;
+    entry.isCardPresent = false;
+    entry.isListed = true;
+    target->entries.push_back(entry);
+
+    wakeUp(target, lock);
+}
+
+void CardTerminalMonitor::removeTerminal(const std::string& name)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    for (const auto& shard : mShards) {
+        for (auto it = shard->entries.begin(); it != shard->entries.end(); ++it) {
+            if (it->name == name) {
+                mLogger->trace("stop monitoring terminal %\n", name);
+                shard->entries.erase(it);
+                wakeUp(shard.get(), lock);
+                return;
+            }
+        }
+    }
+}
+
+void CardTerminalMonitor::setTerminalListListener(std::shared_ptr<TerminalListListener> listener)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    mLogger->trace("% monitoring the terminal list\n", listener ? "start" : "stop");
+
+    mTerminalListListener = listener;
+    mIsTerminalListMonitored = listener != nullptr;
+    mPnpCurrentState = SCARD_STATE_UNAWARE;
+
+    wakeUp(getFirstShard(), lock);
+}
+
+CardTerminalMonitor::Shard* CardTerminalMonitor::createShard()
+{
+    std::unique_ptr<Shard> shard(new Shard());
+    shard->context = 0;
+    shard->isContextEstablished = false;
+    shard->isChanged = false;
+    shard->isStopped = false;
+
+    Shard* const created = shard.get();
+    mShards.push_back(std::move(shard));
+
+    mLogger->debug("starting monitoring thread #%\n", mShards.size());
+    created->thread = std::thread(&CardTerminalMonitor::run, this, created);
+
+    return created;
+}
+
+CardTerminalMonitor::Shard* CardTerminalMonitor::getFirstShard()
+{
+    return mShards.empty() ? createShard() : mShards.front().get();
+}
+
+bool CardTerminalMonitor::isWatchingTerminalList(const Shard* shard) const
+{
+    return mIsTerminalListMonitored && shard == mShards.front().get();
+}
+
+size_t CardTerminalMonitor::getCapacity(const Shard* shard) const
+{
+    /* One slot of the first shard is kept for the PnP notification pseudo-reader */
+    return shard == mShards.front().get() ? MAX_READERS_PER_CALL - 1 : MAX_READERS_PER_CALL;
+}
+
+void CardTerminalMonitor::wakeUp(Shard* shard, std::unique_lock<std::mutex>& lock)
+{
+    shard->isChanged = true;
+    mCondition.notify_all();
+
+    /* Called from a listener: the loop will take the change into account by itself */
+    if (std::this_thread::get_id() == shard->thread.get_id()) {
+        return;
+    }
+
+    /*
+     * Called from a listener of another shard: waiting could deadlock with a listener of the
+     * target shard doing the same, the monitoring threads repeat the cancellation instead
+     */
+    if (isMonitoringThread()) {
+        if (shard->isContextEstablished) {
+            SCardCancel(shard->context);
+        }
+
+        return;
+    }
+
+    while (shard->isChanged && !shard->isStopped) {
+        if (shard->isContextEstablished) {
+            SCardCancel(shard->context);
+        }
+
+        mCondition.wait_for(lock, std::chrono::milliseconds(CANCEL_RETRY_DELAY));
+    }
+}
+
+bool CardTerminalMonitor::cancelPendingWakeUps(const Shard* shard)
+{
+    bool isWakeUpPending = false;
+
+    for (const auto& other : mShards) {
+        if (other.get() != shard && other->isChanged && !other->isStopped) {
+            isWakeUpPending = true;
+            if (other->isContextEstablished) {
+                SCardCancel(other->context);
+            }
+        }
+    }
+
+    return isWakeUpPending;
+}
+
+bool CardTerminalMonitor::isMonitoringThread() const
+{
+    const std::thread::id threadId = std::this_thread::get_id();
+
+    for (const auto& shard : mShards) {
+        if (shard->thread.get_id() == threadId) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void CardTerminalMonitor::notifyMonitoringFailure(Shard* shard,
+                                                  const std::string& reason,
+                                                  std::unique_lock<std::mutex>& lock)
+{
+    std::vector<std::shared_ptr<CardPresenceListener>> listeners;
+
+    for (auto& entry : shard->entries) {
+        /* Notified again by the first call once recovered */
+        entry.currentState = SCARD_STATE_UNAWARE;
+        entry.isPresenceKnown = false;
+
+        const std::shared_ptr<CardPresenceListener> listener = entry.listener.lock();
+        if (listener) {
+            listeners.push_back(listener);
+        }
+    }
+
+    lock.unlock();
+
+    for (const auto& listener : listeners) {
+        listener->onMonitoringFailed(reason);
+    }
+
+    lock.lock();
+}
+
+void CardTerminalMonitor::run(Shard* shard)
+{
+    std::vector<std::string> names;
+    std::vector<SCARD_READERSTATE> readerStates;
+
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    while (mIsRunning) {
+        /* Acknowledge the current set of terminals */
+        shard->isChanged = false;
+        mCondition.notify_all();
+
+        const bool isWatchingList = isWatchingTerminalList(shard);
+
+        if (shard->entries.empty() && !isWatchingList) {
+            /* Nothing to monitor, do not keep a context open while idle */
+            if (shard->isContextEstablished) {
+                SCardReleaseContext(shard->context);
+                shard->isContextEstablished = false;
+            }
+
+            mCondition.wait(lock, [&]() { return !mIsRunning || shard->isChanged; });
+            continue;
+        }
+
+        if (!shard->isContextEstablished) {
+            LONG rv = SCardEstablishContext(SCARD_SCOPE_USER, NULL, NULL, &shard->context);
+            if (rv != SCARD_S_SUCCESS) {
+                mLogger->error("SCardEstablishContext failed with error: %\n",
+                               std::string(pcsc_stringify_error(rv)));
+                notifyMonitoringFailure(shard, std::string(pcsc_stringify_error(rv)), lock);
+                mCondition.wait_for(lock,
+                                    std::chrono::milliseconds(RETRY_DELAY),
+                                    [&]() { return !mIsRunning || shard->isChanged; });
+                continue;
+            }
+
+            shard->isContextEstablished = true;
+
+            /* Ask for the current state of every terminal with the new context */
+            for (auto& entry : shard->entries) {
+                entry.currentState = SCARD_STATE_UNAWARE;
+            }
+
+            if (isWatchingList) {
+                mPnpCurrentState = SCARD_STATE_UNAWARE;
+            }
+        }
+
+        /* The unplugged terminals are left out, SCardGetStatusChange would reject the call */
+        names.clear();
+        std::vector<DWORD> currentStates;
+        bool hasUnlistedTerminal = false;
+        for (const auto& entry : shard->entries) {
+            if (entry.isListed) {
+                names.push_back(entry.name);
+                currentStates.push_back(entry.currentState);
+            } else {
+                hasUnlistedTerminal = true;
+            }
+        }
+
+        readerStates.assign(names.size(), SCARD_READERSTATE());
+        for (size_t i = 0; i < names.size(); i++) {
+            readerStates[i].szReader = names[i].c_str();
+            readerStates[i].dwCurrentState = currentStates[i];
+        }
+
+        /* The unplugged terminals are looked for periodically */
+        DWORD timeout = hasUnlistedTerminal ? TERMINAL_LIST_POLLING_PERIOD : INFINITE;
+        bool isTerminalListChanged = false;
+
+        if (isWatchingList) {
+            if (mIsPnpSupported) {
+                SCARD_READERSTATE pnpState;
+                memset(&pnpState, 0, sizeof(SCARD_READERSTATE));
+                pnpState.szReader = PNP_NOTIFICATION.c_str();
+                pnpState.dwCurrentState = mPnpCurrentState;
+                readerStates.push_back(pnpState);
+            } else {
+                timeout = TERMINAL_LIST_POLLING_PERIOD;
+
+                /* Initial notification, the next ones occur at the end of each period */
+                if (mPnpCurrentState == SCARD_STATE_UNAWARE) {
+                    mPnpCurrentState = SCARD_STATE_IGNORE;
+                    isTerminalListChanged = true;
+                }
+            }
+        }
+
+        /* Changes requested by listeners, see wakeUp */
+        const bool isWakeUpPending = cancelPendingWakeUps(shard);
+        if (isWakeUpPending && timeout > static_cast<DWORD>(CANCEL_RETRY_DELAY)) {
+            timeout = static_cast<DWORD>(CANCEL_RETRY_DELAY);
+        }
+
+        const SCARDCONTEXT context = shard->context;
+
+        lock.unlock();
+
+        if (isTerminalListChanged) {
+            notifyTerminalList(context);
+        }
+
+        LONG rv = SCARD_E_TIMEOUT;
+
+        if (!readerStates.empty()) {
+            rv = SCardGetStatusChange(context,
+                                      timeout,
+                                      readerStates.data(),
+                                      static_cast<DWORD>(readerStates.size()));
+            if (rv == SCARD_S_SUCCESS) {
+                dispatch(shard, names, readerStates);
+            }
+        }
+
+        /*
+         * Either a terminal of the shard has been unplugged before the call (the usual hot-unplug
+         * race) or the PnP pseudo-reader is not supported
+         */
+        bool isUnknownReaderResolved = false;
+        bool isPnpUnsupported = false;
+        if (rv == SCARD_E_UNKNOWN_READER) {
+            isUnknownReaderResolved = refreshListedTerminals(shard, context);
+            if (!isUnknownReaderResolved && isWatchingList && mIsPnpSupported) {
+                isPnpUnsupported = !isPnpNotificationSupported(context);
+                isUnknownReaderResolved = isPnpUnsupported;
+            }
+        } else if (rv == SCARD_E_TIMEOUT && hasUnlistedTerminal) {
+            refreshListedTerminals(shard, context);
+        }
+
+        lock.lock();
+
+        if (readerStates.empty() &&
+            mCondition.wait_for(lock,
+                                std::chrono::milliseconds(timeout),
+                                [&]() { return !mIsRunning || shard->isChanged; })) {
+            /* Only polling the terminal list, interrupted before the end of the period */
+            rv = SCARD_E_CANCELLED;
+        }
+
+        if (isWatchingList && isWatchingTerminalList(shard)) {
+            isTerminalListChanged = false;
+
+            if (rv == SCARD_S_SUCCESS && mIsPnpSupported) {
+                const DWORD pnpEventState = readerStates.back().dwEventState;
+                if (pnpEventState & SCARD_STATE_UNKNOWN) {
+                    mLogger->warn("PnP notification not supported, polling the terminal list\n");
+                    mIsPnpSupported = false;
+                } else if (pnpEventState & SCARD_STATE_CHANGED) {
+                    mPnpCurrentState = pnpEventState & ~SCARD_STATE_CHANGED;
+                    isTerminalListChanged = true;
+                }
+            } else if (rv == SCARD_E_UNKNOWN_READER && isUnknownReaderResolved) {
+                if (isPnpUnsupported) {
+                    mLogger->warn("PnP notification not supported, polling the terminal list\n");
+                    mIsPnpSupported = false;
+                }
+
+                isTerminalListChanged = true;
+            } else if (rv == SCARD_E_TIMEOUT && !mIsPnpSupported && !isWakeUpPending) {
+                isTerminalListChanged = true;
+            }
+
+            if (isTerminalListChanged) {
+                lock.unlock();
+                notifyTerminalList(context);
+                lock.lock();
+            }
+        }
+
+        if (rv == SCARD_S_SUCCESS ||
+            rv == SCARD_E_CANCELLED ||
+            rv == SCARD_E_TIMEOUT ||
+            (rv == SCARD_E_UNKNOWN_READER && isUnknownReaderResolved)) {
+            continue;
+        }
+
+        mLogger->error("SCardGetStatusChange failed with error: %\n",
+                       std::string(pcsc_stringify_error(rv)));
+
+        /* The context won't recover from these, get a fresh one */
+        if (rv == SCARD_E_NO_SERVICE ||
+            rv == SCARD_E_SERVICE_STOPPED ||
+            SCardIsValidContext(shard->context) != SCARD_S_SUCCESS) {
+            SCardReleaseContext(shard->context);
+            shard->isContextEstablished = false;
+        }
+
+        notifyMonitoringFailure(shard, std::string(pcsc_stringify_error(rv)), lock);
+
+        mCondition.wait_for(lock,
+                            std::chrono::milliseconds(RETRY_DELAY),
+                            [&]() { return !mIsRunning || shard->isChanged; });
+    }
+
+    if (shard->isContextEstablished) {
+        SCardReleaseContext(shard->context);
+        shard->isContextEstablished = false;
+    }
+
+    shard->isStopped = true;
+    mCondition.notify_all();
+}
+
+void CardTerminalMonitor::dispatch(Shard* shard,
+                                   const std::vector<std::string>& names,
+                                   const std::vector<SCARD_READERSTATE>& readerStates)
+{
+    struct PresenceEvent {
+        std::shared_ptr<CardPresenceListener> listener;
+        bool isCardPresent;
+        std::vector<uint8_t> atr;
+    };
+
+    std::vector<PresenceEvent> events;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        for (size_t i = 0; i < names.size(); i++) {
+            const DWORD eventState = readerStates[i].dwEventState;
+            if (!(eventState & SCARD_STATE_CHANGED)) {
+                continue;
+            }
+
+            /* The terminal may have been unregistered during the wait */
+            for (auto& entry : shard->entries) {
+                if (entry.name != names[i]) {
+                    continue;
+                }
+
+                const bool isPresent = isCardPresent(eventState);
+                const std::shared_ptr<CardPresenceListener> listener = entry.listener.lock();
+
+                /* The ATR is provided along with the presence, no connection is needed */
+                std::vector<uint8_t> atr;
+                if (isPresent) {
+                    const DWORD atrLength = std::min<DWORD>(readerStates[i].cbAtr,
+                                                            sizeof(readerStates[i].rgbAtr));
+                    atr.assign(readerStates[i].rgbAtr, readerStates[i].rgbAtr + atrLength);
+                }
+
+                if (listener) {
+                    if (!entry.isPresenceKnown || isPresent != entry.isCardPresent) {
+                        events.push_back({listener, isPresent, atr});
+                    } else if (isPresent &&
+                               entry.currentState != SCARD_STATE_UNAWARE &&
+                               (eventState >> 16) != (entry.currentState >> 16)) {
+                        /* The high word counts the events: card swapped between two calls */
+                        events.push_back({listener, false, std::vector<uint8_t>()});
+                        events.push_back({listener, true, atr});
+                    }
+                }
+
+                entry.currentState = eventState & ~SCARD_STATE_CHANGED;
+                entry.isPresenceKnown = true;
+                entry.isCardPresent = isPresent;
+                break;
+            }
+        }
+    }
+
+    for (const auto& event : events) {
+        if (event.isCardPresent) {
+            event.listener->onCardInserted(event.atr);
+        } else {
+            event.listener->onCardRemoved();
+        }
+    }
+}
+
+bool CardTerminalMonitor::refreshListedTerminals(Shard* shard, const SCARDCONTEXT context)
+{
+    std::vector<std::string> terminalNames;
+    if (!listTerminals(context, terminalNames)) {
+        return false;
+    }
+
+    std::vector<std::shared_ptr<CardPresenceListener>> removalListeners;
+    bool isTerminalUnlisted = false;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        for (auto& entry : shard->entries) {
+            const bool isListed = std::find(terminalNames.begin(),
+                                            terminalNames.end(),
+                                            entry.name) != terminalNames.end();
+            if (isListed == entry.isListed) {
+                continue;
+            }
+
+            entry.isListed = isListed;
+            entry.currentState = SCARD_STATE_UNAWARE;
+
+            if (isListed) {
+                mLogger->trace("terminal % listed again\n", entry.name);
+
+                /* The presence is notified by the next SCardGetStatusChange */
+                entry.isPresenceKnown = false;
+                continue;
+            }
+
+            mLogger->trace("terminal % no longer listed\n", entry.name);
+            isTerminalUnlisted = true;
+
+            const std::shared_ptr<CardPresenceListener> listener = entry.listener.lock();
+            if (listener && entry.isPresenceKnown && entry.isCardPresent) {
+                removalListeners.push_back(listener);
+            }
+
+            entry.isPresenceKnown = true;
+            entry.isCardPresent = false;
+        }
+    }
+
+    for (const auto& listener : removalListeners) {
+        listener->onCardRemoved();
+    }
+
+    return isTerminalUnlisted;
+}
+
+bool CardTerminalMonitor::isPnpNotificationSupported(const SCARDCONTEXT context)
+{
+    SCARD_READERSTATE pnpState;
+    memset(&pnpState, 0, sizeof(SCARD_READERSTATE));
+    pnpState.szReader = PNP_NOTIFICATION.c_str();
+    pnpState.dwCurrentState = SCARD_STATE_UNAWARE;
+
+    const LONG rv = SCardGetStatusChange(context, 0, &pnpState, 1);
+    if (rv == SCARD_E_UNKNOWN_READER) {
+        return false;
+    }
+
+    return !(rv == SCARD_S_SUCCESS && (pnpState.dwEventState & SCARD_STATE_UNKNOWN));
+}
+
+void CardTerminalMonitor::notifyTerminalList(const SCARDCONTEXT context)
+{
+    std::vector<std::string> terminalNames;
+    if (!listTerminals(context, terminalNames)) {
+        return;
+    }
+
+    std::shared_ptr<TerminalListListener> listener;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        listener = mTerminalListListener.lock();
+    }
+
+    if (listener) {
+        listener->onTerminalListChanged(terminalNames);
+    }
+}
+
+bool CardTerminalMonitor::listTerminals(const SCARDCONTEXT context,
+                                        std::vector<std::string>& names)
+{
+    DWORD len = 0;
+
+    LONG rv = SCardListReaders(context, NULL, NULL, &len);
+    if (rv == SCARD_E_NO_READERS_AVAILABLE || (rv == SCARD_S_SUCCESS && len == 0)) {
+        /* No readers to add to list */
+        return true;
+    }
+
+    if (rv != SCARD_S_SUCCESS) {
+        return false;
+    }
+
+    std::vector<char> readers(len);
+    rv = SCardListReaders(context, NULL, readers.data(), &len);
+    if (rv == SCARD_E_NO_READERS_AVAILABLE) {
+        return true;
+    }
+
+    if (rv != SCARD_S_SUCCESS) {
+        return false;
+    }
+
+    for (const char* ptr = readers.data(); *ptr; ptr += strlen(ptr) + 1) {
+        names.push_back(ptr);
+    }
+
+    return true;
+}
+
+bool CardTerminalMonitor::isCardPresent(const DWORD state)
+{
+    return (state & SCARD_STATE_PRESENT) && !(state & SCARD_STATE_MUTE);
+}
+
+}
+}
+}
+}
@@ -0,0 +1,304 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <typeinfo>
+#include <vector>
+
+/* Keyple Core Util */
+#include "LoggerFactory.h"
+
+/* Keyple Plugin Pcsc */
+#include "CardPresenceListener.h"
+#include "KeyplePluginPcscExport.h"
+#include "TerminalListListener.h"
+
+/* PC/SC */
+#if defined(WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
+#include <winscard.h>
+#else
+#include <PCSC/winscard.h>
+#include <PCSC/wintypes.h>
+#endif
+
+namespace keyple {
+namespace plugin {
+namespace pcsc {
+namespace cpp {
+
+using namespace keyple::core::util::cpp;
+
+/**
+ * Watches the card presence of a set of terminals with a single SCardGetStatusChange call.
+ *
+ * <p>All registered terminals are put into one SCARD_READERSTATE array monitored by a single
+ * thread. When the number of terminals exceeds what PC/SC accepts in one call, the terminals are
+ * spread over several monitoring threads (shards), each one owning its own context.
+ *
+ * <p>Registering or unregistering a terminal interrupts the pending call with SCardCancel so that
+ * the new set of terminals is taken into account immediately. When requested from a listener, the
+ * change is not waited for: the monitoring threads repeat the SCardCancel until it is taken into
+ * account, so that two threads never wait for each other.
+ *
+ * <p>The PC/SC failures are reported to the listeners of the shard, which are notified of the
+ * card presence again once the monitoring has recovered.
+ *
+ * <p>The first monitoring thread can also watch the "\\?PnP?\Notification" pseudo-reader to
+ * report the plugging and unplugging of terminals. If the platform does not support it, the
+ * terminal list is checked periodically by the same thread.
+ */
+class KEYPLEPLUGINPCSC_API CardTerminalMonitor {
+public:
+    /**
+     *
+     */
+    CardTerminalMonitor();
+
+    /**
+     * Stops all the monitoring threads.
+     */
+    virtual ~CardTerminalMonitor();
+
+    /**
+     * Starts monitoring the card presence of a terminal.
+     *
+     * <p>The listener is notified of the current card presence as soon as it is known, then of
+     * each change. The monitor only keeps a weak reference on the listener.
+     *
+     * @param name The terminal name.
+     * @param listener The listener to notify.
+     */
+    void addTerminal(const std::string& name, std::shared_ptr<CardPresenceListener> listener);
+
+    /**
+     * Stops monitoring the card presence of a terminal.
+     *
+     * <p>Does nothing if the terminal is not monitored.
+     *
+     * @param name The terminal name.
+     */
+    void removeTerminal(const std::string& name);
+
+    /**
+     * Starts (or stops) monitoring the list of terminals.
+     *
+     * <p>The listener is notified with the current list as soon as the monitoring starts, then
+     * each time a terminal is plugged or unplugged. The monitor only keeps a weak reference on the
+     * listener.
+     *
+     * @param listener The listener to notify, null to stop monitoring the list of terminals.
+     */
+    void setTerminalListListener(std::shared_ptr<TerminalListListener> listener);
+
+private:
+    /**
+     *
+     */
+    struct Entry {
+        std::string name;
+        std::weak_ptr<CardPresenceListener> listener;
+        DWORD currentState;
+        bool isPresenceKnown;
+        bool isCardPresent;
+
+        /* false while the terminal is missing from the PC/SC list (unplugged) */
+        bool isListed;
+    };
+
+    /**
+     * A set of terminals small enough to be monitored by one SCardGetStatusChange call.
+     */
+    struct Shard {
+        std::thread thread;
+        SCARDCONTEXT context;
+        bool isContextEstablished;
+        bool isChanged;
+        bool isStopped;
+        std::vector<Entry> entries;
+    };
+
+    /**
+     *
+     */
+    const std::unique_ptr<Logger> mLogger = LoggerFactory::getLogger(typeid(CardTerminalMonitor));
+
+    /**
+     * Maximum number of reader states accepted by one SCardGetStatusChange call.
+     */
+    static const size_t MAX_READERS_PER_CALL;
+
+    /**
+     * Delay (in ms) before retrying after a PC/SC service failure.
+     */
+    static const long RETRY_DELAY;
+
+    /**
+     * Delay (in ms) between two SCardCancel calls when waking up a monitoring thread.
+     *
+     * <p>A cancellation issued just before the thread enters SCardGetStatusChange is lost, it is
+     * therefore repeated until the thread acknowledges it.
+     */
+    static const long CANCEL_RETRY_DELAY;
+
+    /**
+     * Name of the PC/SC pseudo-reader notifying the plugging and unplugging of readers.
+     */
+    static const std::string PNP_NOTIFICATION;
+
+    /**
+     * Period (in ms) of the terminal list check when the PnP notification is not supported.
+     */
+    static const long TERMINAL_LIST_POLLING_PERIOD;
+
+    /**
+     * Protects all the shards.
+     */
+    std::mutex mMutex;
+
+    /**
+     *
+     */
+    std::condition_variable mCondition;
+
+    /**
+     *
+     */
+    bool mIsRunning;
+
+    /**
+     *
+     */
+    std::vector<std::unique_ptr<Shard>> mShards;
+
+    /**
+     * Watched by the first shard.
+     */
+    std::weak_ptr<TerminalListListener> mTerminalListListener;
+
+    /**
+     *
+     */
+    bool mIsTerminalListMonitored;
+
+    /**
+     *
+     */
+    DWORD mPnpCurrentState;
+
+    /**
+     *
+     */
+    bool mIsPnpSupported;
+
+    /**
+     * Monitoring thread body.
+     */
+    void run(Shard* shard);
+
+    /**
+     * Updates the shard entries from the result of SCardGetStatusChange and notifies the
+     * listeners (outside of the lock).
+     */
+    void dispatch(Shard* shard,
+                  const std::vector<std::string>& names,
+                  const std::vector<SCARD_READERSTATE>& readerStates);
+
+    /**
+     * Re-enumerates the terminals after a SCARD_E_UNKNOWN_READER or while some terminals of the
+     * shard are missing: the missing ones are left out of the SCardGetStatusChange calls (their
+     * listener being notified of a card removal) until they are listed again.
+     *
+     * @return true if a terminal of the shard is no longer listed.
+     */
+    bool refreshListedTerminals(Shard* shard, const SCARDCONTEXT context);
+
+    /**
+     * Tells if the PnP notification pseudo-reader is known by the PC/SC service.
+     */
+    static bool isPnpNotificationSupported(const SCARDCONTEXT context);
+
+    /**
+     * Interrupts the pending SCardGetStatusChange of a shard until it has taken into account the
+     * new set of terminals. Must be called with the lock held.
+     *
+     * <p>Does not wait when called from a monitoring thread, the SCardCancel being then repeated
+     * by the monitoring threads (see cancelPendingWakeUps).
+     */
+    void wakeUp(Shard* shard, std::unique_lock<std::mutex>& lock);
+
+    /**
+     * Repeats the SCardCancel of the other shards whose change has not been taken into account
+     * yet. Must be called with the lock held.
+     *
+     * @return true if a change is pending.
+     */
+    bool cancelPendingWakeUps(const Shard* shard);
+
+    /**
+     * Tells if the current thread is a monitoring thread. Must be called with the lock held.
+     */
+    bool isMonitoringThread() const;
+
+    /**
+     * Notifies the listeners of the shard of a failure (outside of the lock), the card presence
+     * being notified again once recovered. Must be called with the lock held.
+     */
+    void notifyMonitoringFailure(Shard* shard,
+                                 const std::string& reason,
+                                 std::unique_lock<std::mutex>& lock);
+
+    /**
+     * Creates a shard and starts its monitoring thread. Must be called with the lock held.
+     */
+    Shard* createShard();
+
+    /**
+     * Gets the first shard, creating it if needed. Must be called with the lock held.
+     */
+    Shard* getFirstShard();
+
+    /**
+     * Tells if the shard watches the terminal list. Must be called with the lock held.
+     */
+    bool isWatchingTerminalList(const Shard* shard) const;
+
+    /**
+     * Number of terminals a shard can monitor. Must be called with the lock held.
+     */
+    size_t getCapacity(const Shard* shard) const;
+
+    /**
+     * Lists the terminals and notifies the terminal list listener (outside of the lock).
+     */
+    void notifyTerminalList(const SCARDCONTEXT context);
+
+    /**
+     *
+     */
+    static bool listTerminals(const SCARDCONTEXT context, std::vector<std::string>& names);
+
+    /**
+     *
+     */
+    static bool isCardPresent(const DWORD state);
+};
+
+}
+}
+}
+}
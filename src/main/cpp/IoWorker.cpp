@@ -0,0 +1,213 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include "IoWorker.h"
+
+#include <exception>
+
+namespace keyple {
+namespace plugin {
+namespace pcsc {
+namespace cpp {
+
+IoWorker::IoWorker(const std::string& name)
+: mName(name),
+  mHead(&mStub),
+  mTail(&mStub),
+  mQueueDepth(0),
+  mExecutedTaskCount(0),
+  mTotalWaitTime(0),
+  mMaxWaitTime(0),
+  mIsRunning(true),
+  mIsWaiting(false)
+{
+    mStub.next.store(nullptr);
+
+    mThread = std::thread(&IoWorker::run, this);
+}
+
+IoWorker::~IoWorker()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        mIsRunning = false;
+        mCondition.notify_all();
+    }
+
+    if (mThread.joinable()) {
+        mThread.join();
+    }
+
+    /* The producers are gone, the pending tasks are completed by their discard function */
+    Node* node;
+    while ((node = pop()) != nullptr) {
+        if (node->discard) {
+            try {
+                node->discard();
+            } catch (const std::exception& e) {
+                mLogger->error("[%] I/O task discard failed: %\n", mName, e.what());
+            } catch (...) {
+                mLogger->error("[%] I/O task discard failed with an unknown exception\n", mName);
+            }
+        }
+
+        delete node;
+    }
+}
+
+bool IoWorker::submit(const std::function<void()>& task, const std::function<void()>& discard)
+{
+    if (!mIsRunning) {
+        return false;
+    }
+
+    Node* node = new Node();
+    node->task = task;
+    node->discard = discard;
+    node->submissionTime = std::chrono::steady_clock::now();
+
+    /* Counted before being linked, the worker does not sleep while a node is being linked */
+    mQueueDepth++;
+    push(node);
+
+    if (mIsWaiting) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mCondition.notify_one();
+    }
+
+    return true;
+}
+
+size_t IoWorker::getQueueDepth() const
+{
+    return mQueueDepth;
+}
+
+uint64_t IoWorker::getExecutedTaskCount() const
+{
+    return mExecutedTaskCount;
+}
+
+uint64_t IoWorker::getTotalWaitTime() const
+{
+    return mTotalWaitTime;
+}
+
+uint64_t IoWorker::getMaxWaitTime() const
+{
+    return mMaxWaitTime;
+}
+
+void IoWorker::push(Node* node)
+{
+    node->next.store(nullptr, std::memory_order_relaxed);
+
+    Node* previous = mHead.exchange(node, std::memory_order_acq_rel);
+    previous->next.store(node, std::memory_order_release);
+}
+
+IoWorker::Node* IoWorker::pop()
+{
+    Node* tail = mTail;
+    Node* next = tail->next.load(std::memory_order_acquire);
+
+    if (tail == &mStub) {
+        if (next == nullptr) {
+            return nullptr;
+        }
+
+        mTail = next;
+        tail = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+
+    if (next != nullptr) {
+        mTail = next;
+        return tail;
+    }
+
+    if (tail != mHead.load(std::memory_order_acquire)) {
+        /* A producer is linking its node */
+        return nullptr;
+    }
+
+    /* Last node: the stub takes its place so that it can be unlinked */
+    push(&mStub);
+
+    next = tail->next.load(std::memory_order_acquire);
+    if (next != nullptr) {
+        mTail = next;
+        return tail;
+    }
+
+    return nullptr;
+}
+
+void IoWorker::run()
+{
+    while (true) {
+        Node* node = pop();
+
+        if (node == nullptr) {
+            if (mQueueDepth > 0 && mIsRunning) {
+                /* A node is being linked */
+                std::this_thread::yield();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(mMutex);
+
+            mIsWaiting = true;
+            mCondition.wait(lock, [this]() { return !mIsRunning || mQueueDepth > 0; });
+            mIsWaiting = false;
+
+            if (!mIsRunning) {
+                return;
+            }
+
+            continue;
+        }
+
+        const uint64_t waitTime = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - node->submissionTime).count());
+
+        mTotalWaitTime += waitTime;
+        uint64_t maxWaitTime = mMaxWaitTime;
+        while (waitTime > maxWaitTime &&
+               !mMaxWaitTime.compare_exchange_weak(maxWaitTime, waitTime)) {
+        }
+
+        try {
+            node->task();
+        } catch (const std::exception& e) {
+            mLogger->error("[%] I/O task failed: %\n", mName, e.what());
+        } catch (...) {
+            mLogger->error("[%] I/O task failed with an unknown exception\n", mName);
+        }
+
+        delete node;
+
+        mExecutedTaskCount++;
+        mQueueDepth--;
+
+        if (!mIsRunning) {
+            return;
+        }
+    }
+}
+
+}
+}
+}
+}
@@ -0,0 +1,195 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <typeinfo>
+
+/* Keyple Core Util */
+#include "LoggerFactory.h"
+
+/* Keyple Plugin Pcsc */
+#include "KeyplePluginPcscExport.h"
+
+namespace keyple {
+namespace plugin {
+namespace pcsc {
+namespace cpp {
+
+using namespace keyple::core::util::cpp;
+
+/**
+ * Dedicated thread executing the I/O tasks of a reader in submission order.
+ *
+ * <p>The tasks are submitted through a lock-free multi-producer single-consumer queue: submitting
+ * never blocks, the mutex is only taken to wake the worker up when it is idle.
+ *
+ * <p>The queue depth and the time spent by the tasks in the queue are measured.
+ */
+class KEYPLEPLUGINPCSC_API IoWorker final {
+public:
+    /**
+     * Starts the worker thread.
+     *
+     * @param name The name used in the logs (e.g. the reader name).
+     */
+    explicit IoWorker(const std::string& name);
+
+    /**
+     * Waits for the running task, stops the thread, then discards the pending tasks.
+     */
+    ~IoWorker();
+
+    /**
+     * Queues a task.
+     *
+     * <p>Exceptions thrown by the task or by its discard function are logged and ignored.
+     *
+     * @param task The task to execute.
+     * @param discard The function called instead of the task if the worker is destroyed before
+     *     executing it (e.g. to complete the task with an error), may be null.
+     * @return false if the worker is stopping, the task is then not queued.
+     */
+    bool submit(const std::function<void()>& task, const std::function<void()>& discard);
+
+    /**
+     * @return The number of tasks queued or running.
+     */
+    size_t getQueueDepth() const;
+
+    /**
+     * @return The number of tasks executed.
+     */
+    uint64_t getExecutedTaskCount() const;
+
+    /**
+     * @return The cumulated time spent by the executed tasks in the queue (in microseconds).
+     */
+    uint64_t getTotalWaitTime() const;
+
+    /**
+     * @return The longest time spent by a task in the queue (in microseconds).
+     */
+    uint64_t getMaxWaitTime() const;
+
+private:
+    /**
+     * Queue node, the queue always holds at least one node.
+     */
+    struct Node {
+        std::atomic<Node*> next;
+        std::function<void()> task;
+        std::function<void()> discard;
+        std::chrono::steady_clock::time_point submissionTime;
+    };
+
+    /**
+     *
+     */
+    const std::unique_ptr<Logger> mLogger = LoggerFactory::getLogger(typeid(IoWorker));
+
+    /**
+     *
+     */
+    const std::string mName;
+
+    /**
+     * Node put back in the queue when the last task is consumed, so that the queue is never
+     * empty.
+     */
+    Node mStub;
+
+    /**
+     * Last node queued, exchanged by the producers.
+     */
+    std::atomic<Node*> mHead;
+
+    /**
+     * Next node to consume, only accessed by the worker thread.
+     */
+    Node* mTail;
+
+    /**
+     * Tasks submitted and not completed yet.
+     */
+    std::atomic<size_t> mQueueDepth;
+
+    /**
+     *
+     */
+    std::atomic<uint64_t> mExecutedTaskCount;
+
+    /**
+     *
+     */
+    std::atomic<uint64_t> mTotalWaitTime;
+
+    /**
+     *
+     */
+    std::atomic<uint64_t> mMaxWaitTime;
+
+    /**
+     *
+     */
+    std::atomic<bool> mIsRunning;
+
+    /**
+     * True while the worker is waiting for a task, the producers then have to notify it.
+     */
+    std::atomic<bool> mIsWaiting;
+
+    /**
+     *
+     */
+    std::mutex mMutex;
+
+    /**
+     *
+     */
+    std::condition_variable mCondition;
+
+    /**
+     *
+     */
+    std::thread mThread;
+
+    /**
+     * Links a node at the head of the queue (any thread).
+     */
+    void push(Node* node);
+
+    /**
+     * Unlinks the node at the tail of the queue (worker thread).
+     *
+     * @return nullptr if the queue is empty or if a producer has not linked its node yet.
+     */
+    Node* pop();
+
+    /**
+     * Worker thread body.
+     */
+    void run();
+};
+
+}
+}
+}
+}
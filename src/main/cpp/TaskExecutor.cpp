@@ -0,0 +1,127 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include "TaskExecutor.h"
+
+#include <exception>
+
+namespace keyple {
+namespace plugin {
+namespace pcsc {
+namespace cpp {
+
+TaskExecutor::TaskExecutor(const size_t maxThreadCount)
+: mMaxThreadCount(maxThreadCount > 0 ? maxThreadCount : 1),
+  mReservedThreadCount(0),
+  mIdleThreadCount(0),
+  mIsRunning(true) {}
+
+TaskExecutor::~TaskExecutor()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        mIsRunning = false;
+        mTasks.clear();
+        mCondition.notify_all();
+        mIdleCondition.notify_all();
+    }
+
+    for (auto& thread : mThreads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+void TaskExecutor::execute(const std::function<void()>& task)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (!mIsRunning) {
+        return;
+    }
+
+    mTasks.push_back(task);
+
+    if (mIdleThreadCount < mTasks.size() &&
+        mThreads.size() < mMaxThreadCount + mReservedThreadCount) {
+        mLogger->debug("starting worker thread #%\n", mThreads.size() + 1);
+        mThreads.push_back(std::thread(&TaskExecutor::run, this));
+    } else {
+        mCondition.notify_one();
+    }
+}
+
+void TaskExecutor::waitUntilIdle()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    mIdleCondition.wait(lock, [this]() {
+        return !mIsRunning || (mTasks.empty() && mIdleThreadCount == mThreads.size());
+    });
+}
+
+void TaskExecutor::reserveThread()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    mReservedThreadCount++;
+}
+
+void TaskExecutor::releaseThread()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (mReservedThreadCount > 0) {
+        mReservedThreadCount--;
+    }
+}
+
+void TaskExecutor::run()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    while (true) {
+        mIdleThreadCount++;
+        mIdleCondition.notify_all();
+        mCondition.wait(lock, [&]() { return !mIsRunning || !mTasks.empty(); });
+        mIdleThreadCount--;
+
+        if (!mIsRunning) {
+            return;
+        }
+
+        std::function<void()> task = std::move(mTasks.front());
+        mTasks.pop_front();
+
+        lock.unlock();
+
+        try {
+            task();
+        } catch (const std::exception& e) {
+            mLogger->error("task failed: %\n", e.what());
+        } catch (...) {
+            mLogger->error("task failed with an unknown exception\n");
+        }
+
+        /* Released unlocked, the task may hold the last reference to a user of this executor */
+        task = nullptr;
+
+        lock.lock();
+    }
+}
+
+}
+}
+}
+}
@@ -0,0 +1,144 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <typeinfo>
+#include <vector>
+
+/* Keyple Core Util */
+#include "LoggerFactory.h"
+
+/* Keyple Plugin Pcsc */
+#include "KeyplePluginPcscExport.h"
+
+namespace keyple {
+namespace plugin {
+namespace pcsc {
+namespace cpp {
+
+using namespace keyple::core::util::cpp;
+
+/**
+ * Bounded pool of threads executing tasks in submission order.
+ *
+ * <p>Threads are only created when a task is submitted while all the existing ones are busy, up to
+ * the maximum provided at construction.
+ */
+class KEYPLEPLUGINPCSC_API TaskExecutor {
+public:
+    /**
+     *
+     * @param maxThreadCount The maximum number of threads (at least 1).
+     */
+    explicit TaskExecutor(const size_t maxThreadCount);
+
+    /**
+     * Discards the pending tasks, waits for the running ones and stops the threads.
+     */
+    virtual ~TaskExecutor();
+
+    /**
+     * Queues a task.
+     *
+     * <p>Exceptions thrown by the task are logged and ignored.
+     *
+     * @param task The task to execute.
+     */
+    void execute(const std::function<void()>& task);
+
+    /**
+     * Blocks until no task is queued nor running, including the tasks queued meanwhile by the
+     * running ones.
+     *
+     * <p>Must not be called from a task.
+     */
+    void waitUntilIdle();
+
+    /**
+     * Allows one more thread, for a user needing a thread of its own to never wait for the tasks
+     * of the others.
+     */
+    void reserveThread();
+
+    /**
+     * Cancels a reserveThread call, the threads already started are kept.
+     */
+    void releaseThread();
+
+private:
+    /**
+     *
+     */
+    const std::unique_ptr<Logger> mLogger = LoggerFactory::getLogger(typeid(TaskExecutor));
+
+    /**
+     * Maximum number of threads given at construction.
+     */
+    const size_t mMaxThreadCount;
+
+    /**
+     * Number of threads allowed in addition to mMaxThreadCount.
+     */
+    size_t mReservedThreadCount;
+
+    /**
+     *
+     */
+    std::mutex mMutex;
+
+    /**
+     *
+     */
+    std::condition_variable mCondition;
+
+    /**
+     * Notified when a thread becomes idle.
+     */
+    std::condition_variable mIdleCondition;
+
+    /**
+     *
+     */
+    std::deque<std::function<void()>> mTasks;
+
+    /**
+     *
+     */
+    std::vector<std::thread> mThreads;
+
+    /**
+     *
+     */
+    size_t mIdleThreadCount;
+
+    /**
+     *
+     */
+    bool mIsRunning;
+
+    /**
+     * Worker thread body.
+     */
+    void run();
+};
+
+}
+}
+}
+}
@@ -0,0 +1,50 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+/* Keyple Plugin Pcsc */
+#include "KeyplePluginPcscExport.h"
+
+namespace keyple {
+namespace plugin {
+namespace pcsc {
+namespace cpp {
+
+/**
+ * Receives the terminal list changes detected by a {@link CardTerminalMonitor}.
+ *
+ * <p>Notifications are made from the monitoring thread, implementations must not call back the
+ * monitor.
+ */
+class KEYPLEPLUGINPCSC_API TerminalListListener {
+public:
+    /**
+     *
+     */
+    virtual ~TerminalListListener() = default;
+
+    /**
+     * Invoked when the list of terminals may have changed (and once when the monitoring starts).
+     *
+     * @param terminalNames The names of all the terminals currently available.
+     */
+    virtual void onTerminalListChanged(const std::vector<std::string>& terminalNames) = 0;
+};
+
+}
+}
+}
+}
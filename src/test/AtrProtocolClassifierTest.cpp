@@ -0,0 +1,170 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+/* Keyple Core Util */
+#include "HexUtil.h"
+#include "Matcher.h"
+#include "Pattern.h"
+
+/* Keyple Plugin Pcsc */
+#include "AtrProtocolClassifier.h"
+#include "PcscSupportedContactProtocol.h"
+#include "PcscSupportedContactlessProtocol.h"
+
+using namespace testing;
+
+using namespace keyple::core::util;
+using namespace keyple::core::util::cpp;
+using namespace keyple::plugin::pcsc;
+
+static const std::vector<std::vector<uint8_t>> SAMPLE_ATRS = {
+    /* ISO 14443-4 */
+    {0x3B, 0x88, 0x80, 0x01, 0x00, 0x00, 0x00, 0x00, 0x33, 0x81, 0x81, 0x00, 0x3A},
+    {0x3B, 0x8B, 0x80, 0x01, 0x80, 0x66, 0x47, 0x50, 0x41, 0x00, 0x00, 0x00, 0x00},
+    {0x3B, 0x8C, 0x80, 0x01, 0x50, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    /* Innovatron B prime */
+    {0x3B, 0x8F, 0x80, 0x01, 0x80, 0x5A, 0x0A, 0x01, 0x03, 0x20, 0x03, 0x11, 0x00, 0x00, 0x00,
+     0x00, 0x00, 0x82, 0x90, 0x00, 0x00},
+    /* Mifare Classic 1K and Ultralight */
+    {0x3B, 0x8F, 0x80, 0x01, 0x80, 0x4F, 0x0C, 0xA0, 0x00, 0x00, 0x03, 0x06, 0x03, 0x00, 0x01,
+     0x00, 0x00, 0x00, 0x00, 0x6A},
+    {0x3B, 0x8F, 0x80, 0x01, 0x80, 0x4F, 0x0C, 0xA0, 0x00, 0x00, 0x03, 0x06, 0x03, 0x00, 0x03,
+     0x00, 0x00, 0x00, 0x00, 0x68},
+    /* Mifare Desfire */
+    {0x3B, 0x81, 0x80, 0x01, 0x80, 0x80},
+    /* ST25 */
+    {0x3B, 0x8F, 0x80, 0x01, 0x80, 0x4F, 0x0C, 0xA0, 0x00, 0x00, 0x03, 0x06, 0x07, 0x00, 0x07,
+     0xD0, 0x02, 0x0C, 0x00, 0xB6},
+    /* Contact */
+    {0x3B, 0x16, 0x96, 0x41, 0x73, 0x74, 0x72, 0x69, 0x64},
+    {0x3F, 0x65, 0x25, 0x00, 0x2C, 0x09, 0x69, 0x90, 0x00},
+    /* Empty */
+    {}};
+
+static std::vector<std::string> getDefaultRules()
+{
+    return {PcscSupportedContactlessProtocol::ISO_14443_4.getDefaultRule(),
+            PcscSupportedContactlessProtocol::INNOVATRON_B_PRIME_CARD.getDefaultRule(),
+            PcscSupportedContactlessProtocol::MIFARE_ULTRA_LIGHT.getDefaultRule(),
+            PcscSupportedContactlessProtocol::MIFARE_CLASSIC.getDefaultRule(),
+            PcscSupportedContactlessProtocol::MIFARE_DESFIRE.getDefaultRule(),
+            PcscSupportedContactlessProtocol::MEMORY_ST25.getDefaultRule(),
+            PcscSupportedContactProtocol::ISO_7816_3.getDefaultRule(),
+            PcscSupportedContactProtocol::ISO_7816_3_T0.getDefaultRule(),
+            PcscSupportedContactProtocol::ISO_7816_3_T1.getDefaultRule()};
+}
+
+/* The samples, then random ATRs made of their bytes so that the rules match partially */
+static std::vector<std::vector<uint8_t>> getAtrs()
+{
+    std::vector<std::vector<uint8_t>> atrs = SAMPLE_ATRS;
+
+    std::vector<uint8_t> bytes;
+    for (const std::vector<uint8_t>& atr : SAMPLE_ATRS) {
+        bytes.insert(bytes.end(), atr.begin(), atr.end());
+    }
+
+    std::mt19937 random(1);
+    for (int i = 0; i < 2000; i++) {
+        std::vector<uint8_t> atr(random() % 24);
+        for (uint8_t& byte : atr) {
+            byte = bytes[random() % bytes.size()];
+        }
+        atrs.push_back(atr);
+
+        /* A sample with one nibble changed */
+        atr = SAMPLE_ATRS[random() % SAMPLE_ATRS.size()];
+        if (!atr.empty()) {
+            atr[random() % atr.size()] ^= static_cast<uint8_t>(1 << (random() % 8));
+        }
+        atrs.push_back(atr);
+    }
+
+    return atrs;
+}
+
+/* Checks the classifier against one regular expression per rule */
+static void assertMatchesPatterns(const std::vector<std::string>& rules)
+{
+    const AtrProtocolClassifier classifier(rules);
+
+    std::vector<std::shared_ptr<Pattern>> patterns;
+    for (const std::string& rule : rules) {
+        patterns.push_back(rule.empty() ? nullptr
+                                        : std::shared_ptr<Pattern>(Pattern::compile(rule)));
+    }
+
+    std::vector<bool> protocols;
+    for (const std::vector<uint8_t>& atr : getAtrs()) {
+        const std::string atrHex = HexUtil::toHex(atr);
+
+        classifier.classify(atr, protocols);
+
+        ASSERT_EQ(protocols.size(), rules.size());
+        for (size_t i = 0; i < rules.size(); i++) {
+            const bool isMatching =
+                patterns[i] != nullptr && patterns[i]->matcher(atrHex)->matches();
+            ASSERT_EQ(protocols[i], isMatching) << "rule " << rules[i] << ", ATR " << atrHex;
+        }
+    }
+}
+
+TEST(AtrProtocolClassifierTest, classify_withDefaultRules_shouldMatchPatterns)
+{
+    assertMatchesPatterns(getDefaultRules());
+}
+
+TEST(AtrProtocolClassifierTest, classify_withLettersOutsideHex_shouldMatchPatterns)
+{
+    assertMatchesPatterns({"X", "3BG.*", "3B8.Z.*|3B8F.*", "3b8f.*"});
+}
+
+TEST(AtrProtocolClassifierTest, classify_withFallbackConstructs_shouldMatchPatterns)
+{
+    assertMatchesPatterns({"3B8[0-9A-F]80.*",
+                           "^3B.*$",
+                           "3B(88|8F)80.*",
+                           "3B8F8001804F0CA0000003060300(01|03).*",
+                           "3F6525?00.*",
+                           "3B.{2}80.*"});
+}
+
+TEST(AtrProtocolClassifierTest, classify_withAutomatonAndFallbackRules_shouldMatchPatterns)
+{
+    std::vector<std::string> rules = getDefaultRules();
+    rules.push_back("3B8[0-9A-F]80.*");
+    rules.push_back("X");
+    rules.push_back("^3F.*");
+    rules.push_back("3B8.8.*1|A|");
+
+    assertMatchesPatterns(rules);
+}
+
+TEST(AtrProtocolClassifierTest, classify_whenRuleIsEmpty_shouldNeverMatch)
+{
+    const AtrProtocolClassifier classifier({"", "3B.*"});
+
+    std::vector<bool> protocols;
+    classifier.classify({}, protocols);
+    ASSERT_EQ(protocols, std::vector<bool>({false, false}));
+
+    classifier.classify({0x3B, 0x88}, protocols);
+    ASSERT_EQ(protocols, std::vector<bool>({false, true}));
+}
@@ -0,0 +1,137 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+/* Keyple Plugin Pcsc */
+#include "AnswerToReset.h"
+
+using namespace testing;
+
+using namespace keyple::plugin::pcsc::cpp;
+
+/* Calypso card: TD1 (T=0), TD2 (T=1), 8 historical bytes, TCK */
+static const std::vector<uint8_t> CALYPSO_ATR = {
+    0x3B, 0x88, 0x80, 0x01, 0x00, 0x00, 0x00, 0x00, 0x33, 0x81, 0x81, 0x00, 0x3A};
+
+/* Mifare Classic 1K reported in the PC/SC Part 3 storage card format */
+static const std::vector<uint8_t> MIFARE_CLASSIC_ATR = {
+    0x3B, 0x8F, 0x80, 0x01, 0x80, 0x4F, 0x0C, 0xA0, 0x00, 0x00, 0x03, 0x06, 0x03, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x00, 0x6A};
+
+/* Contact card: TA1 only (T=0 implicit, no TCK), 6 historical bytes */
+static const std::vector<uint8_t> CONTACT_ATR = {
+    0x3B, 0x16, 0x96, 0x41, 0x73, 0x74, 0x72, 0x69, 0x64};
+
+TEST(AnswerToResetTest, constructor_whenAtrHasSeveralLevels_shouldDecodeInterfaceBytes)
+{
+    const AnswerToReset atr(CALYPSO_ATR);
+
+    ASSERT_TRUE(atr.isValid());
+    ASSERT_EQ(atr.getTs(), 0x3B);
+    ASSERT_EQ(atr.getT0(), 0x88);
+    ASSERT_EQ(atr.getTa(1), AnswerToReset::ABSENT);
+    ASSERT_EQ(atr.getTd(1), 0x80);
+    ASSERT_EQ(atr.getTd(2), 0x01);
+    ASSERT_EQ(atr.getTd(3), AnswerToReset::ABSENT);
+    ASSERT_EQ(atr.getTa(0), AnswerToReset::ABSENT);
+    ASSERT_EQ(atr.getTa(4), AnswerToReset::ABSENT);
+    ASSERT_EQ(atr.getProtocols(), 0x0003);
+    ASSERT_TRUE(atr.isProtocolOffered(0));
+    ASSERT_TRUE(atr.isProtocolOffered(1));
+    ASSERT_FALSE(atr.isProtocolOffered(15));
+    ASSERT_FALSE(atr.isProtocolOffered(16));
+    ASSERT_TRUE(atr.hasTck());
+    ASSERT_EQ(atr.getHistoricalBytes(),
+              std::vector<uint8_t>({0x00, 0x00, 0x00, 0x00, 0x33, 0x81, 0x81, 0x00}));
+    ASSERT_FALSE(atr.isStorageCard());
+    ASSERT_TRUE(atr.getRid().empty());
+}
+
+TEST(AnswerToResetTest, constructor_whenTa1IsPresent_shouldDecodeFiAndDi)
+{
+    const AnswerToReset atr(CONTACT_ATR);
+
+    ASSERT_TRUE(atr.isValid());
+    ASSERT_EQ(atr.getTa(1), 0x96);
+    ASSERT_EQ(atr.getFi(), 512);
+    ASSERT_EQ(atr.getDi(), 32);
+    ASSERT_EQ(atr.getProtocols(), 0x0001);
+    ASSERT_FALSE(atr.hasTck());
+    ASSERT_EQ(atr.getHistoricalBytes(),
+              std::vector<uint8_t>({0x41, 0x73, 0x74, 0x72, 0x69, 0x64}));
+}
+
+TEST(AnswerToResetTest, getFi_whenTa1IsAbsentOrReserved_shouldReturnDefaultOrZero)
+{
+    ASSERT_EQ(AnswerToReset(CALYPSO_ATR).getFi(), 372);
+    ASSERT_EQ(AnswerToReset(CALYPSO_ATR).getDi(), 1);
+
+    const AnswerToReset atr({0x3B, 0x10, 0x7A});
+    ASSERT_TRUE(atr.isValid());
+    ASSERT_EQ(atr.getFi(), 0);
+    ASSERT_EQ(atr.getDi(), 0);
+}
+
+TEST(AnswerToResetTest, constructor_whenStorageCard_shouldDecodePcscPart3Fields)
+{
+    const AnswerToReset atr(MIFARE_CLASSIC_ATR);
+
+    ASSERT_TRUE(atr.isValid());
+    ASSERT_TRUE(atr.isStorageCard());
+    ASSERT_EQ(atr.getRid(), std::vector<uint8_t>({0xA0, 0x00, 0x00, 0x03, 0x06}));
+    ASSERT_EQ(atr.getStandard(), 0x03);
+    ASSERT_EQ(atr.getCardName(), 0x0001);
+}
+
+TEST(AnswerToResetTest, constructor_whenTckIsWrong_shouldBeInvalid)
+{
+    std::vector<uint8_t> bytes = CALYPSO_ATR;
+    bytes.back() ^= 0x01;
+
+    const AnswerToReset atr(bytes);
+
+    ASSERT_FALSE(atr.isValid());
+    ASSERT_EQ(atr.getHistoricalBytes().size(), 8U);
+}
+
+TEST(AnswerToResetTest, constructor_whenAtrIsTruncated_shouldKeepDecodedFields)
+{
+    const AnswerToReset atr({0x3B, 0x8F, 0x80});
+
+    ASSERT_FALSE(atr.isValid());
+    ASSERT_EQ(atr.getTd(1), 0x80);
+    ASSERT_EQ(atr.getTd(2), AnswerToReset::ABSENT);
+    ASSERT_TRUE(atr.getHistoricalBytes().empty());
+}
+
+TEST(AnswerToResetTest, constructor_whenAtrIsMalformed_shouldBeInvalid)
+{
+    ASSERT_FALSE(AnswerToReset().isValid());
+    ASSERT_FALSE(AnswerToReset(std::vector<uint8_t>()).isValid());
+    ASSERT_FALSE(AnswerToReset({0x3B}).isValid());
+    ASSERT_FALSE(AnswerToReset({0x3C, 0x00}).isValid());
+
+    /* A byte after the historical bytes of an ATR without TCK */
+    std::vector<uint8_t> bytes = CONTACT_ATR;
+    bytes.push_back(0x00);
+    ASSERT_FALSE(AnswerToReset(bytes).isValid());
+
+    /* Missing TCK */
+    bytes = CALYPSO_ATR;
+    bytes.pop_back();
+    ASSERT_FALSE(AnswerToReset(bytes).isValid());
+}
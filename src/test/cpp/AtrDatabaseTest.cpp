@@ -0,0 +1,138 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+/* Keyple Core Util */
+#include "IllegalArgumentException.h"
+
+/* Keyple Plugin Pcsc */
+#include "AtrDatabase.h"
+
+using namespace testing;
+
+using namespace keyple::core::util::cpp::exception;
+using namespace keyple::plugin::pcsc::cpp;
+
+static const std::string DATABASE_PATH = "AtrDatabaseTest.kpatrdb";
+
+static std::shared_ptr<AtrDatabase> writeAndOpen(const std::vector<AtrDatabase::Entry>& entries)
+{
+    AtrDatabase::write(DATABASE_PATH, entries);
+    std::shared_ptr<AtrDatabase> database = AtrDatabase::open(DATABASE_PATH);
+    std::remove(DATABASE_PATH.c_str());
+
+    return database;
+}
+
+static std::string lookup(const std::shared_ptr<AtrDatabase>& database,
+                          const std::vector<uint8_t>& atr)
+{
+    return database->getCardType(database->lookup(atr));
+}
+
+TEST(AtrDatabaseTest, lookup_whenPrefixMatches_shouldReturnEntry)
+{
+    const std::shared_ptr<AtrDatabase> database =
+        writeAndOpen({{{0x3B, 0x8F, 0x80, 0x01}, {}, "Contactless card"},
+                      {{0x3B, 0x02}, {}, "Contact card"}});
+
+    ASSERT_EQ(database->getEntryCount(), 2U);
+    ASSERT_EQ(lookup(database, {0x3B, 0x8F, 0x80, 0x01, 0x80, 0x4F}), "Contactless card");
+    ASSERT_EQ(lookup(database, {0x3B, 0x02, 0x14, 0x50}), "Contact card");
+}
+
+TEST(AtrDatabaseTest, lookup_whenNoEntryMatches_shouldReturnMinusOne)
+{
+    const std::shared_ptr<AtrDatabase> database =
+        writeAndOpen({{{0x3B, 0x8F, 0x80, 0x01}, {}, "Contactless card"}});
+
+    ASSERT_EQ(database->lookup({0x3B, 0x8F, 0x81}), -1);
+    ASSERT_EQ(database->lookup({0x3B, 0x8F}), -1);
+    ASSERT_EQ(database->getCardType(-1), "");
+}
+
+TEST(AtrDatabaseTest, lookup_whenMasksOverlap_shouldReturnMostSpecificEntry)
+{
+    const std::shared_ptr<AtrDatabase> database =
+        writeAndOpen({{{0x3B, 0x80, 0x80}, {0xFF, 0xF0, 0xFF}, "Any 3B8x80"},
+                      {{0x3B, 0x8F, 0x80}, {}, "3B8F80"},
+                      {{0x3B, 0x00, 0x80}, {0xFF, 0x00, 0xFF}, "Any 3Bxx80"}});
+
+    ASSERT_EQ(lookup(database, {0x3B, 0x8F, 0x80}), "3B8F80");
+    ASSERT_EQ(lookup(database, {0x3B, 0x8E, 0x80}), "Any 3B8x80");
+    ASSERT_EQ(lookup(database, {0x3B, 0x7F, 0x80}), "Any 3Bxx80");
+}
+
+TEST(AtrDatabaseTest, lookup_whenMasksAreAsSpecific_shouldReturnFirstEntry)
+{
+    const std::shared_ptr<AtrDatabase> database =
+        writeAndOpen({{{0x3B, 0x80}, {0xFF, 0xF0}, "Any 3B8x"},
+                      {{0x3B, 0x0F}, {0xFF, 0x0F}, "Any 3BxF"}});
+
+    ASSERT_EQ(lookup(database, {0x3B, 0x8F}), "Any 3B8x");
+    ASSERT_EQ(lookup(database, {0x3B, 0x7F}), "Any 3BxF");
+}
+
+TEST(AtrDatabaseTest, lookup_whenSeveralPrefixesMatch_shouldReturnLongestOne)
+{
+    const std::shared_ptr<AtrDatabase> database =
+        writeAndOpen({{{0x3B, 0x8F, 0x80, 0x01}, {}, "3B8F8001"},
+                      {{0x3B, 0x00, 0x00, 0x00, 0x00}, {0xFF, 0x00, 0x00, 0x00, 0x00}, "Any 3B"}});
+
+    ASSERT_EQ(lookup(database, {0x3B, 0x8F, 0x80, 0x01}), "3B8F8001");
+    ASSERT_EQ(lookup(database, {0x3B, 0x8F, 0x80, 0x01, 0x80}), "Any 3B");
+}
+
+TEST(AtrDatabaseTest, write_whenMaskLengthDiffers_shouldThrowIAE)
+{
+    EXPECT_THROW(AtrDatabase::write(DATABASE_PATH, {{{0x3B, 0x8F}, {0xFF}, "Card"}}),
+                 IllegalArgumentException);
+}
+
+TEST(AtrDatabaseTest, write_whenMasksExpandTooMuch_shouldThrowIAE)
+{
+    /* Each entry fixes a different byte, every subset of the entries is a distinct node */
+    std::vector<AtrDatabase::Entry> entries;
+    for (size_t i = 0; i < 10; i++) {
+        AtrDatabase::Entry entry;
+        entry.atr.assign(10, 0x00);
+        entry.mask.assign(10, 0x00);
+        entry.atr[i] = 0x01;
+        entry.mask[i] = 0xFF;
+        entry.cardType = "Card " + std::to_string(i);
+        entries.push_back(entry);
+    }
+
+    EXPECT_THROW(AtrDatabase::write(DATABASE_PATH, entries, 1000), IllegalArgumentException);
+
+    AtrDatabase::write(DATABASE_PATH, entries, 4096);
+    std::remove(DATABASE_PATH.c_str());
+}
+
+TEST(AtrDatabaseTest, open_whenFileIsNotADatabase_shouldThrowIAE)
+{
+    {
+        std::ofstream file(DATABASE_PATH, std::ios::binary | std::ios::trunc);
+        file << "not an ATR database";
+    }
+
+    EXPECT_THROW(AtrDatabase::open(DATABASE_PATH), IllegalArgumentException);
+
+    std::remove(DATABASE_PATH.c_str());
+}
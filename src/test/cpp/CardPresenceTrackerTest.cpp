@@ -0,0 +1,145 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+
+#include <chrono>
+#include <future>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+/* Keyple Plugin Pcsc */
+#include "CardException.h"
+#include "CardPresenceTracker.h"
+
+using namespace testing;
+
+using namespace keyple::plugin::pcsc::cpp;
+using namespace keyple::plugin::pcsc::cpp::exception;
+
+using WaitResult = CardPresenceTracker::WaitResult;
+
+static const long SHORT_TIMEOUT = 20;
+static const long LONG_TIMEOUT = 10000;
+
+TEST(CardPresenceTrackerTest, waitForCardPresence_whenPresenceIsNotReached_shouldTimeOut)
+{
+    CardPresenceTracker tracker;
+
+    ASSERT_EQ(tracker.waitForCardPresence(true, SHORT_TIMEOUT), WaitResult::TIMED_OUT);
+
+    tracker.onCardRemoved();
+
+    ASSERT_EQ(tracker.waitForCardPresence(true, SHORT_TIMEOUT), WaitResult::TIMED_OUT);
+    ASSERT_EQ(tracker.waitForCardPresence(false, SHORT_TIMEOUT), WaitResult::REACHED);
+}
+
+TEST(CardPresenceTrackerTest, waitForCardPresence_whenCardIsInserted_shouldReturnReached)
+{
+    CardPresenceTracker tracker;
+    tracker.onCardRemoved();
+
+    std::future<WaitResult> result = std::async(std::launch::async, [&tracker]() {
+        return tracker.waitForCardPresence(true, LONG_TIMEOUT);
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(SHORT_TIMEOUT));
+    tracker.onCardInserted({0x3B, 0x00});
+
+    ASSERT_EQ(result.get(), WaitResult::REACHED);
+
+    bool isCardPresent = false;
+    ASSERT_TRUE(tracker.getLastCardPresence(isCardPresent));
+    ASSERT_TRUE(isCardPresent);
+}
+
+TEST(CardPresenceTrackerTest, cancel_whenWaitIsBlocked_shouldReleaseItImmediately)
+{
+    CardPresenceTracker tracker;
+    tracker.onCardRemoved();
+
+    const auto start = std::chrono::steady_clock::now();
+    std::future<WaitResult> result = std::async(std::launch::async, [&tracker]() {
+        return tracker.waitForCardPresence(true, LONG_TIMEOUT);
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(SHORT_TIMEOUT));
+    tracker.cancel(true);
+
+    ASSERT_EQ(result.get(), WaitResult::CANCELLED);
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(LONG_TIMEOUT));
+}
+
+TEST(CardPresenceTrackerTest, cancel_whenNoWaitIsBlocked_shouldCancelNextWaitOnly)
+{
+    CardPresenceTracker tracker;
+    tracker.onCardRemoved();
+
+    tracker.cancel(true);
+
+    ASSERT_EQ(tracker.waitForCardPresence(true, LONG_TIMEOUT), WaitResult::CANCELLED);
+    ASSERT_EQ(tracker.waitForCardPresence(true, SHORT_TIMEOUT), WaitResult::TIMED_OUT);
+}
+
+TEST(CardPresenceTrackerTest, cancel_shouldOnlyTargetWaitsForProvidedPresence)
+{
+    CardPresenceTracker tracker;
+    tracker.onCardRemoved();
+
+    tracker.cancel(true);
+
+    /* Waiting for the opposite presence is not cancelled, and discards the kept cancellation */
+    ASSERT_EQ(tracker.waitForCardPresence(false, LONG_TIMEOUT), WaitResult::REACHED);
+    ASSERT_EQ(tracker.waitForCardPresence(true, SHORT_TIMEOUT), WaitResult::TIMED_OUT);
+}
+
+TEST(CardPresenceTrackerTest, cancel_whenLastWaitHasReachedPresence_shouldBeIgnored)
+{
+    CardPresenceTracker tracker;
+    tracker.onCardInserted({0x3B, 0x00});
+
+    ASSERT_EQ(tracker.waitForCardPresence(true, LONG_TIMEOUT), WaitResult::REACHED);
+
+    tracker.cancel(true);
+    tracker.onCardRemoved();
+
+    ASSERT_EQ(tracker.waitForCardPresence(true, SHORT_TIMEOUT), WaitResult::TIMED_OUT);
+}
+
+TEST(CardPresenceTrackerTest, waitForCardPresence_whenMonitoringFailed_shouldThrowCE)
+{
+    CardPresenceTracker tracker;
+    tracker.onCardRemoved();
+    tracker.onMonitoringFailed("SCARD_E_NO_SERVICE");
+
+    EXPECT_THROW(tracker.waitForCardPresence(true, LONG_TIMEOUT), CardException);
+
+    /* Recovered once the card presence is notified again */
+    tracker.onCardRemoved();
+
+    ASSERT_EQ(tracker.waitForCardPresence(false, LONG_TIMEOUT), WaitResult::REACHED);
+}
+
+TEST(CardPresenceTrackerTest, onMonitoringFailed_whenWaitIsBlocked_shouldMakeItThrowCE)
+{
+    CardPresenceTracker tracker;
+    tracker.onCardRemoved();
+
+    std::future<WaitResult> result = std::async(std::launch::async, [&tracker]() {
+        return tracker.waitForCardPresence(true, LONG_TIMEOUT);
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(SHORT_TIMEOUT));
+    tracker.onMonitoringFailed("SCARD_E_NO_SERVICE");
+
+    EXPECT_THROW(result.get(), CardException);
+}
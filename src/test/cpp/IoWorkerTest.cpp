@@ -0,0 +1,139 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+/* Keyple Plugin Pcsc */
+#include "IoWorker.h"
+
+using namespace testing;
+
+using namespace keyple::plugin::pcsc::cpp;
+
+static const int PRODUCER_COUNT = 4;
+static const int TASK_COUNT = 1000;
+
+/* Waits for the tasks submitted before to be executed */
+static void waitUntilIdle(IoWorker& worker)
+{
+    std::promise<void> executed;
+    ASSERT_TRUE(worker.submit([&executed]() { executed.set_value(); }, nullptr));
+    executed.get_future().wait();
+
+    while (worker.getQueueDepth() > 0) {
+        std::this_thread::yield();
+    }
+}
+
+TEST(IoWorkerTest, submit_fromSeveralThreads_shouldExecuteTasksOfEachThreadInOrder)
+{
+    IoWorker worker("Reader");
+
+    /* Only accessed by the worker thread until it is idle */
+    std::vector<std::pair<int, int>> executions;
+
+    std::vector<std::thread> producers;
+    for (int producer = 0; producer < PRODUCER_COUNT; producer++) {
+        producers.emplace_back([&worker, &executions, producer]() {
+            for (int i = 0; i < TASK_COUNT; i++) {
+                worker.submit([&executions, producer, i]() { executions.push_back({producer, i}); },
+                              nullptr);
+            }
+        });
+    }
+
+    for (std::thread& producer : producers) {
+        producer.join();
+    }
+
+    waitUntilIdle(worker);
+
+    ASSERT_EQ(executions.size(), static_cast<size_t>(PRODUCER_COUNT * TASK_COUNT));
+
+    std::vector<int> nextIndexes(PRODUCER_COUNT, 0);
+    for (const std::pair<int, int>& execution : executions) {
+        ASSERT_EQ(execution.second, nextIndexes[execution.first]++);
+    }
+
+    ASSERT_EQ(worker.getExecutedTaskCount(),
+              static_cast<uint64_t>(PRODUCER_COUNT * TASK_COUNT + 1));
+    ASSERT_GE(worker.getTotalWaitTime(), worker.getMaxWaitTime());
+}
+
+TEST(IoWorkerTest, submit_whenTaskThrows_shouldExecuteNextTasks)
+{
+    IoWorker worker("Reader");
+    bool isExecuted = false;
+
+    worker.submit([]() { throw std::runtime_error("Task failure"); }, nullptr);
+    worker.submit([]() { throw 1; }, nullptr);
+    worker.submit([&isExecuted]() { isExecuted = true; }, nullptr);
+
+    waitUntilIdle(worker);
+
+    ASSERT_TRUE(isExecuted);
+    ASSERT_EQ(worker.getExecutedTaskCount(), 4U);
+}
+
+TEST(IoWorkerTest, destructor_shouldWaitForRunningTaskAndDiscardPendingOnes)
+{
+    /* Used until its destructor returns, hence not owned by a smart pointer */
+    IoWorker* worker = new IoWorker("Reader");
+
+    std::promise<void> started;
+    std::promise<void> released;
+    std::shared_future<void> release = released.get_future().share();
+    std::atomic<bool> isRunningTaskCompleted(false);
+    std::atomic<int> executedCount(0);
+    std::atomic<int> discardedCount(0);
+
+    worker->submit(
+        [&started, release, &isRunningTaskCompleted]() {
+            started.set_value();
+            release.wait();
+            isRunningTaskCompleted = true;
+        },
+        nullptr);
+
+    for (int i = 0; i < 10; i++) {
+        worker->submit([&executedCount]() { executedCount++; },
+                       [&discardedCount]() { discardedCount++; });
+    }
+
+    /* A throwing discard function does not prevent the other ones */
+    worker->submit([]() {}, []() { throw std::runtime_error("Discard failure"); });
+
+    started.get_future().wait();
+
+    std::thread destroyer([worker]() { delete worker; });
+
+    /* The worker refuses the tasks once stopping, while still waiting for the running one */
+    while (worker->submit([]() {}, nullptr)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    released.set_value();
+    destroyer.join();
+
+    ASSERT_TRUE(isRunningTaskCompleted);
+    ASSERT_EQ(executedCount, 0);
+    ASSERT_EQ(discardedCount, 10);
+}
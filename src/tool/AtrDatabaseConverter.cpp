@@ -0,0 +1,129 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+/*
+ * Converts a text list of ATR prefixes into an ATR database file (see
+ * PcscPluginFactoryBuilder::Builder::useAtrDatabase).
+ *
+ * Usage: keyplepluginpcscatrdb <input text file> <output database file>
+ *
+ * Input format, one entry per line:
+ *
+ *     <ATR prefix>[/<mask>] <card type>
+ *
+ * - the ATR prefix and the optional mask are hex strings of the same length, a byte of the ATR
+ *   being compared to the prefix byte through the mask byte (e.g. "3B8F80/FFFFF0" ignores the
+ *   low nibble of the third byte), no mask meaning that all the bits are compared,
+ * - the card type is the rest of the line, leading and trailing blanks removed, it may contain
+ *   blanks but can not be empty,
+ * - empty lines and lines starting with '#' are ignored.
+ *
+ * When several entries match an ATR, the longest prefix wins, then the one with the most mask
+ * bits set, then the first one of the file.
+ */
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/* Keyple Core Util */
+#include "Exception.h"
+#include "HexUtil.h"
+
+/* Keyple Plugin Pcsc */
+#include "AtrDatabase.h"
+
+using namespace keyple::core::util;
+using namespace keyple::core::util::cpp::exception;
+using namespace keyple::plugin::pcsc::cpp;
+
+static const char* const BLANKS = " \t\r";
+
+/* Parses a non empty line, returns false if it is malformed */
+static bool parseEntry(const std::string& line, AtrDatabase::Entry& entry)
+{
+    const size_t keyStart = line.find_first_not_of(BLANKS);
+    const size_t keyEnd = line.find_first_of(BLANKS, keyStart);
+    if (keyEnd == std::string::npos) {
+        return false;
+    }
+
+    const std::string key = line.substr(keyStart, keyEnd - keyStart);
+    const size_t slash = key.find('/');
+    const std::string atr = key.substr(0, slash);
+    const std::string mask = slash != std::string::npos ? key.substr(slash + 1) : "";
+
+    if (atr.empty() ||
+        !HexUtil::isValid(atr) ||
+        (slash != std::string::npos && (mask.size() != atr.size() || !HexUtil::isValid(mask)))) {
+        return false;
+    }
+
+    const size_t cardTypeStart = line.find_first_not_of(BLANKS, keyEnd);
+    if (cardTypeStart == std::string::npos) {
+        return false;
+    }
+
+    const size_t cardTypeEnd = line.find_last_not_of(BLANKS);
+
+    entry.atr = HexUtil::toByteArray(atr);
+    entry.mask = mask.empty() ? std::vector<uint8_t>() : HexUtil::toByteArray(mask);
+    entry.cardType = line.substr(cardTypeStart, cardTypeEnd - cardTypeStart + 1);
+
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <input text file> <output database file>"
+                  << std::endl;
+        return 2;
+    }
+
+    std::ifstream input(argv[1]);
+    if (!input) {
+        std::cerr << "Unable to read " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::vector<AtrDatabase::Entry> entries;
+    std::string line;
+
+    for (int lineNumber = 1; std::getline(input, line); lineNumber++) {
+        const size_t start = line.find_first_not_of(BLANKS);
+        if (start == std::string::npos || line[start] == '#') {
+            continue;
+        }
+
+        AtrDatabase::Entry entry;
+        if (!parseEntry(line, entry)) {
+            std::cerr << argv[1] << ":" << lineNumber
+                      << ": expected '<ATR prefix>[/<mask>] <card type>'" << std::endl;
+            return 1;
+        }
+
+        entries.push_back(entry);
+    }
+
+    try {
+        AtrDatabase::write(argv[2], entries);
+    } catch (const Exception& e) {
+        std::cerr << e.getMessage() << std::endl;
+        return 1;
+    }
+
+    std::cout << entries.size() << " entries written to " << argv[2] << std::endl;
+
+    return 0;
+}